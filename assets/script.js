@@ -0,0 +1,293 @@
+function openTab(evt, tabName) {
+    var i, tabcontent, tablinks;
+    tabcontent = document.getElementsByClassName("tabcontent");
+    for (i = 0; i < tabcontent.length; i++) {
+        tabcontent[i].className = tabcontent[i].className.replace(" active", "").replace(" hidden", "") +
+            (tabcontent[i].id === tabName ? " active" : " hidden");
+    }
+    tablinks = document.getElementsByClassName("tablinks");
+    for (i = 0; i < tablinks.length; i++) {
+        tablinks[i].className = tablinks[i].className.replace(" active", "");
+    }
+    evt.currentTarget.className += " active";
+    loadTabContent(tabName);
+}
+
+// When the server is busy, it responds with 503 and the number of seconds
+// to wait before retrying. Returns the delay in milliseconds, spread out so
+// that browsers do not all retry at once; or -1 if the request can not be retried.
+function retryDelay(req) {
+    if (req.status !== 503) {
+        return -1;
+    }
+    var seconds = parseInt(req.getResponseHeader("Retry-After"), 10);
+    return (isNaN(seconds) ? 2 : seconds) * 1000 + Math.random() * 1000;
+}
+
+// Only the first tab is sent with the page; others are constructed from
+// the schema when first opened.
+var settingsSchema = null;
+function loadSchema(callback) {
+    if (settingsSchema !== null) {
+        callback();
+        return;
+    }
+    var req = new XMLHttpRequest();
+    req.overrideMimeType("application/json");
+    req.open("GET", "/settings/schema", true);
+    req.onload = function () {
+        var delay = retryDelay(this);
+        if (delay >= 0) {
+            setTimeout(function () { loadSchema(callback); }, delay);
+            return;
+        }
+        if (this.status === 200) {
+            settingsSchema = JSON.parse(this.responseText);
+        }
+        callback();
+    };
+    req.onerror = callback;
+    req.send(null);
+}
+
+// Produces the same HTML as the server does for the first tab.
+function renderSetting(panelId, s) {
+    var uid = panelId + "$" + s.n,
+        fields = 'id="' + uid + '" name="' + uid + '"',
+        label = '<label for="' + uid + '">' + s.d + '</label>',
+        html,
+        i;
+    switch (s.t) {
+    case "note":
+        return '<div class="note">' + s.d + '</div>';
+    case "info":
+        return '<span class="info" ' + fields + '></span>' + label;
+    case "password":
+        return '<span class="password_group"><input type="checkbox" id="' + panelId + '$pw$' + s.n +
+            '" onchange=\'document.getElementById("' + uid + '").disabled = !event.target.checked;\'>' +
+            '<input type="password" ' + fields + ' disabled="true"></span>' + label;
+    case "select":
+        html = '<select ' + fields + '>';
+        for (i = 0; i < s.o.length; ++i) {
+            html += '<option name="' + uid + '_' + (i + 1) + '">' + s.o[i] + '</option>';
+        }
+        return html + '</select>' + label;
+    default:
+        return '<input type="' + s.t + '" ' + fields +
+            (s.min !== undefined ? ' min="' + s.min + '"' : '') +
+            (s.step !== undefined ? ' step="' + s.step + '"' : '') + ' />' + label;
+    }
+}
+
+function renderPanel(panel) {
+    var html = '<input type="hidden" name="' + panel.i + '$" value="1">';
+    for (var i = 0; i < panel.s.length; ++i) {
+        html += renderSetting(panel.i, panel.s[i]);
+    }
+    return html + '<div style="clear: both"></div>';
+}
+
+function loadTabContent(tabName) {
+    var tab = document.getElementById(tabName);
+    if (tab.getAttribute("data-lazy") !== "true") {
+        return;
+    }
+    tab.setAttribute("data-lazy", "loading");
+    loadSchema(function () {
+        var panel = null;
+        for (var i = 0; settingsSchema !== null && i < settingsSchema.length; ++i) {
+            if (settingsSchema[i].i === tabName) {
+                panel = settingsSchema[i];
+            }
+        }
+        if (panel === null) {
+            tab.setAttribute("data-lazy", "true");
+            return;
+        }
+        tab.innerHTML = renderPanel(panel);
+        tab.removeAttribute("data-lazy");
+        // Scripts inserted through innerHTML do not run; replace them with new elements that will.
+        var scripts = tab.getElementsByTagName("script");
+        for (i = 0; i < scripts.length; ++i) {
+            var script = document.createElement("script");
+            script.text = scripts[i].text;
+            scripts[i].parentNode.replaceChild(script, scripts[i]);
+        }
+        reloadTab(tabName);
+    });
+}
+
+// Values for any number of tabs are fetched in a single request. For
+// incremental requests, only values changed since the previous response
+// for the same query are returned.
+var valueVersions = {};
+function requestValues(query, incremental) {
+    var req = new XMLHttpRequest(),
+        url = "/settings/get?" + query;
+    if (incremental && valueVersions[query] !== undefined) {
+        url += "&since=" + valueVersions[query];
+    }
+    req.overrideMimeType("application/json");
+    req.open("GET", url, true);
+    req.onload = function () {
+        var delay = retryDelay(this);
+        if (delay >= 0) {
+            setTimeout(function () { requestValues(query, incremental); }, delay);
+            return;
+        }
+        if (this.status !== 200) {
+            return;
+        }
+        var version = this.getResponseHeader("X-Settings-Version");
+        if (version !== null) {
+            valueVersions[query] = version;
+        }
+        applyValues(JSON.parse(this.responseText));
+    };
+    req.send(null);
+}
+
+function reloadAllTabs() {
+    var tabcontent = document.getElementsByClassName("tabcontent"),
+        tabs = [];
+    for (var i = 0; i < tabcontent.length; i++) {
+        // Tabs not yet loaded have no controls; their values are loaded with them.
+        if (!tabcontent[i].hasAttribute("data-lazy")) {
+            tabs.push("tab=" + encodeURIComponent(tabcontent[i].id));
+        }
+    }
+    if (tabs.length !== 0) {
+        requestValues(tabs.join("&"));
+    }
+}
+
+function applyValues(r) {
+    var k = Object.keys(r);
+    for (var i = 0; i < k.length; ++i)
+    {
+        for (var j = 0; j < r[k[i]].length; ++j)
+        {
+            setControlValue(k[i], r[k[i]][j]);
+        }
+    }
+}
+
+function reloadTab(t) {
+    requestValues("tab=" + encodeURIComponent(t));
+}
+
+function setControlValue(t, json) {
+    var element = document.getElementById(t + "$" + json.name),
+        tag,
+        type;
+    if (element === null) { // Could be a note. Not updated (usually).
+        return;
+    }
+    tag = element.tagName.toUpperCase();
+    if (element.type !== undefined) {
+        type = element.type.toUpperCase() ;
+    }
+    if (tag === "DIV" || tag === "SPAN") {
+        element.innerHTML = json.value;
+    } else if (tag === "INPUT" && type == "NUMBER") {
+        element.value = parseFloat(json.value);
+    } else if (tag === "INPUT" && type == "CHECKBOX") {
+        element.checked = json.value === true;
+    } else {
+        element.value = json.value;
+    }
+}
+
+window.addEventListener("load", reloadAllTabs);
+
+function sendData(name) {
+    document.getElementById("disable_overlay").style.display = "block";
+    var XHR = new XMLHttpRequest(),
+    form = document.getElementById(name + "_form"),
+    FD = new FormData( form );
+    XHR.addEventListener("load", function(event) {
+        if (this.status == 200)
+        {
+            alert("Saved settings");
+        }
+        else if (this.status == 401)
+        {
+            alert("Settings not saved, authentication failed");
+        }
+        else
+        {
+            alert("Settings not saved, server response: " + this.statusText);
+        }
+        document.getElementById("disable_overlay").style.display = "none";
+    });
+    XHR.addEventListener("error", function( event ) {
+        alert("Submitting settings failed");
+        document.getElementById("disable_overlay").style.display = "none";
+    });
+    XHR.open("POST", "/" + name + "/set");
+    XHR.send( FD );
+}
+
+var periodicUpdateList = [];
+
+// Info setting values are pushed by the server while the events channel
+// is connected; they are only polled when it is not.
+var eventsConnected = false;
+if (typeof EventSource !== "undefined") {
+    var settingsEvents = new EventSource("/settings/events");
+    settingsEvents.onopen = function () {
+        eventsConnected = true;
+    };
+    settingsEvents.onerror = function () {
+        eventsConnected = false;
+    };
+    settingsEvents.addEventListener("values", function (event) {
+        applyValues(JSON.parse(event.data));
+    });
+}
+
+// Whether a periodic update list entry for a single setting is pushed by the server.
+function isPushed(tab, entry) {
+    var element = document.getElementById(tab + "$" + entry.substring(entry.indexOf("=") + 1));
+    return eventsConnected && element !== null && element.className === "info";
+}
+
+// Update only the active tab, to minimize load. All entries for the tab
+// are combined into one request.
+// Should work in Chrome, IE 9.0+, Edge, Firefox, Safari, Opera.
+function periodicUpdate() {
+    if (periodicUpdateList.length !== 0)
+    {
+        var activeTab = document.getElementsByClassName("tabcontent active")[0].id,
+            wholeTab = false,
+            settings = "";
+        for (var i = 0; i < periodicUpdateList.length; ++i)
+        {
+            if (periodicUpdateList[i] == activeTab)
+            {
+                wholeTab = true;
+            }
+            else if (periodicUpdateList[i].substring(0, activeTab.length + 1) === (activeTab + "&") &&
+                !isPushed(activeTab, periodicUpdateList[i]))
+            {
+                settings += periodicUpdateList[i].substring(activeTab.length);
+            }
+        }
+        if (wholeTab)
+        {
+            requestValues("tab=" + encodeURIComponent(activeTab), true);
+        }
+        else if (settings !== "")
+        {
+            requestValues("tab=" + encodeURIComponent(activeTab) + settings, true);
+        }
+    }
+}
+
+setInterval(periodicUpdate, 5000);
+
+function factoryReset() {
+    if (confirm("Reset all to factory defaults: this will erase all settings, including WiFi\n.Are you sure?")) {
+        document.location = "/factoryreset?confirm=true";
+    }
+}
@@ -0,0 +1,183 @@
+#include <ESP8266WiFi.h>
+#include <LittleFS.h>
+#include <WString.h>
+
+#include <memory>
+#include <vector>
+
+#include <esp8266_web_settings.h>
+
+///////////////////////////////////////////////////////////////////////////////////
+// A benchmark for the settings server.
+//
+// This builds a synthetic configuration of `setting_count` settings, in tabs of
+// `settings_per_tab`, and times the operations available to an application. It then
+// serves the settings with request metrics and heap instrumentation enabled, so that
+// the request handlers can be measured with tools/benchmark.py:
+//
+//     python tools/benchmark.py http://<device address>/
+//
+// Change `setting_count` (e.g. to 10, 100 and 250) to compare configurations. The
+// ESP8266 heap does not allow many more than 250 settings; each takes about 60 bytes,
+// plus the name and description. To compare configurations before flashing, including
+// larger ones, use the host benchmark: `pio test -e native -f test_benchmark -v`.
+
+// The access point to connect to.
+static const char wifi_ssid[] PROGMEM = "your-ssid";
+static const char wifi_password[] PROGMEM = "your-password";
+
+static constexpr size_t setting_count = 100;       //!< The number of synthetic settings.
+static constexpr size_t settings_per_tab = 10;     //!< The number of settings in each tab.
+static constexpr int iterations = 20;              //!< The number of times each operation is timed.
+
+static const char settings_path[] PROGMEM = "/benchmark.bin";
+
+static grmcdorman::WebSettings web_settings;    //!< The settings web server. Default port (80).
+
+// The synthetic settings. The names are generated, so they are in RAM; this works
+// because PROGMEM strings can be read from RAM on the ESP8266. The setting lists
+// are held by reference by `web_settings`, so `tabs` is never reallocated.
+static std::unique_ptr<char[]> names;
+static std::vector<std::unique_ptr<grmcdorman::SettingInterface>> settings;
+static std::vector<grmcdorman::SettingInterface::settings_list_t> tabs;
+
+/**
+ * @brief Time an operation, and report the time and the heap it used.
+ *
+ * @param name          The name of the operation.
+ * @param operation     The operation.
+ * @param count         The number of times to run the operation.
+ */
+static void measure(const __FlashStringHelper *name, const std::function<void()> &operation, int count = iterations)
+{
+    uint32_t free_before = ESP.getFreeHeap();
+    uint32_t free_low = free_before;
+    uint32_t start = micros();
+    for (int i = 0; i < count; ++i)
+    {
+        operation();
+        free_low = std::min(free_low, ESP.getFreeHeap());
+        yield();
+    }
+    uint32_t elapsed = micros() - start;
+    uint32_t free_after = ESP.getFreeHeap();
+
+    char label[32];
+    strncpy_P(label, reinterpret_cast<PGM_P>(name), sizeof(label) - 1);
+    label[sizeof(label) - 1] = '\0';
+    Serial.printf_P(PSTR("%-28s %8u us/op  heap %+6d retained  %6u peak  max block %u\n"),
+        label, elapsed / count,
+        static_cast<int>(free_before) - static_cast<int>(free_after), free_before - free_low, ESP.getMaxFreeBlockSize());
+}
+
+//!< Get a generated name, as if it were a PROGMEM string.
+static const __FlashStringHelper *name_at(size_t index)
+{
+    return reinterpret_cast<const __FlashStringHelper *>(&names[index * 8]);
+}
+
+//!< Create the synthetic settings and tabs: text, number and checkbox settings in turn.
+static void create_settings()
+{
+    size_t tab_count = (setting_count + settings_per_tab - 1) / settings_per_tab;
+    names.reset(new char[(setting_count + tab_count) * 8]);
+    settings.reserve(setting_count);
+    tabs.reserve(tab_count);
+    for (size_t i = 0; i < setting_count; ++i)
+    {
+        snprintf_P(&names[i * 8], 8, PSTR("s%u"), i);
+        switch (i % 3)
+        {
+            case 0:
+                settings.emplace_back(new grmcdorman::StringSetting(name_at(i), name_at(i)));
+                break;
+            case 1:
+                settings.emplace_back(new grmcdorman::UnsignedIntegerSetting(name_at(i), name_at(i)));
+                break;
+            default:
+                settings.emplace_back(new grmcdorman::ToggleSetting(name_at(i), name_at(i)));
+                break;
+        }
+        if (i % settings_per_tab == 0)
+        {
+            tabs.emplace_back();
+        }
+        tabs.back().push_back(settings.back().get());
+    }
+    for (size_t tab = 0; tab < tab_count; ++tab)
+    {
+        snprintf_P(&names[(setting_count + tab) * 8], 8, PSTR("t%u"), tab);
+    }
+}
+
+void setup()
+{
+    Serial.begin(115200);
+    Serial.println();
+    Serial.printf_P(PSTR("%u settings in tabs of %u\n"), setting_count, settings_per_tab);
+
+    measure(F("create settings"), create_settings, 1);
+    measure(F("add_setting_set (all tabs)"), [] ()
+    {
+        for (size_t tab = 0; tab < tabs.size(); ++tab)
+        {
+            web_settings.add_setting_set(name_at(setting_count + tab), tabs[tab]);
+        }
+    }, 1);
+
+    // Change every setting, so that all have values to save.
+    for (size_t i = 0; i < setting_count; ++i)
+    {
+        settings[i]->set_from_string(String(i));
+    }
+    uint32_t version = grmcdorman::SettingInterface::get_current_version();
+    measure(F("get_changes_since (none)"), [version] ()
+    {
+        web_settings.get_changes_since(version);
+    });
+    measure(F("get_changes_since (all)"), [] ()
+    {
+        web_settings.get_changes_since(0);
+    });
+
+    if (LittleFS.begin())
+    {
+        measure(F("save_settings"), [] ()
+        {
+            web_settings.save_settings(LittleFS, FPSTR(settings_path));
+        });
+        measure(F("load_settings"), [] ()
+        {
+            web_settings.load_settings(LittleFS, FPSTR(settings_path));
+        });
+        LittleFS.remove(FPSTR(settings_path));
+    }
+    else
+    {
+        Serial.println(F("LittleFS is not available; not timing save and load"));
+    }
+    measure(F("save_restart_snapshot"), [] ()
+    {
+        web_settings.save_restart_snapshot();
+    });
+
+    // Serve the settings, for tools/benchmark.py.
+    WiFi.mode(WIFI_STA);
+    WiFi.begin(FPSTR(wifi_ssid), FPSTR(wifi_password));
+    while (WiFi.status() != WL_CONNECTED)
+    {
+        delay(100);
+    }
+    web_settings.set_metrics(true);
+    web_settings.set_heap_debug(true);
+    web_settings.setup(nullptr, nullptr, nullptr);
+
+    Serial.print(F("Serving at http://"));
+    Serial.print(WiFi.localIP().toString());
+    Serial.println('/');
+}
+
+void loop()
+{
+    web_settings.loop();
+}
@@ -1,4 +1,3 @@
-#include <ArduinoJson.h>
 #include <DNSServer.h>
 #include <ESP8266WiFi.h>
 #include <LittleFS.h>
@@ -8,7 +7,6 @@
 
 // Forward declarations
 static void wifi_setup();
-static std::optional<DynamicJsonDocument> LoadConfig();
 
 // Forward declarations for the three web_settings callbacks.
 
@@ -53,7 +51,7 @@ static ::grmcdorman::SettingInterface::settings_list_t
             &rssi, &uptime};
 
 // Path to the config file
-static const char config_path[] PROGMEM = "/config.json";
+static const char config_path[] PROGMEM = "/settings.bin";
 
 static grmcdorman::WebSettings web_settings;    //!< The settings web server. Default port (80).
 
@@ -137,17 +135,22 @@ void setup()
         uptime.set(message);
     });
 
-    // Load settings, if they exist.
-    auto config = LoadConfig();
-    if (config)
+    // Add our one tab to the web server. This is done before loading, as
+    // stored values are identified by tab and setting.
+    web_settings.add_setting_set(F("WiFi"), F("wifi_settings"), settings);
+
+    // After a restart requested from the web page, the settings are in RTC memory.
+    bool restored = web_settings.restore_restart_snapshot();
+
+    // Otherwise, load settings, if they exist. Changes are then saved
+    // to the same file from `web_settings.loop()`.
+    if (LittleFS.begin())
     {
-        for (auto &setting: settings)
+        if (!restored)
         {
-            if (setting->is_persistable() && !(*config)[setting->name()].isNull())
-            {
-                setting->set_from_string((*config)[setting->name()]);
-            }
+            web_settings.load_settings(LittleFS, FPSTR(config_path));
         }
+        web_settings.set_settings_journal(LittleFS, FPSTR(config_path));
     }
 
     Serial.println("Starting with host name " + hostname.get());
@@ -155,9 +158,6 @@ void setup()
     // Apply loaded WiFi settings
     wifi_setup();
 
-    // Add our one tab to the web server.
-    web_settings.add_setting_set(F("WiFi"), F("wifi_settings"), settings);
-
     // Add an extra handler.
     web_settings.get_server().on("/heap", HTTP_GET, [](AsyncWebServerRequest *request){
         request->send(200, "text/plain", String(ESP.getFreeHeap()));
@@ -165,6 +165,7 @@ void setup()
 
     // Set up the web server and page.
     web_settings.setup(on_save, on_restart, on_factory_reset);
+    web_settings.set_restart_snapshot(true);
     // If we are connected to an AP, set credentials.
     if (WiFi.status() == WL_CONNECTED)
     {
@@ -199,6 +200,8 @@ void loop()
 
     if (restart_next_loop && millis() - restart_reset_when > restart_reset_delay)
     {
+        // Don't lose a save that is still waiting for further changes.
+        web_settings.flush_settings_journal();
         ESP.restart();
     }
 }
@@ -302,34 +305,6 @@ static void wifi_setup()
     }
 }
 
-static std::optional<DynamicJsonDocument> LoadConfig()
-{
-    if (!LittleFS.begin()) {
-        return std::nullopt;
-    }
-
-    if (!LittleFS.exists(FPSTR(config_path))) {
-        return std::nullopt;
-    }
-
-    File configFile = LittleFS.open(FPSTR(config_path), "r");
-
-    if (!configFile) {
-        return std::nullopt;
-    }
-
-    DynamicJsonDocument json(configFile.size() * 10);
-
-    auto status = deserializeJson(json, configFile);
-    if (DeserializationError::Ok != status) {
-        Serial.print(F("Deserialization error: "));
-        Serial.println(status.c_str());
-        return std::nullopt;
-    }
-    return std::move(json);
-}
-
-
 static void on_factory_reset(::grmcdorman::WebSettings &)
 {
     factory_reset_next_loop = true;
@@ -342,23 +317,8 @@ static void on_restart(::grmcdorman::WebSettings &)
     restart_reset_when = millis();
 }
 
-static void on_save(::grmcdorman::WebSettings &)
+static void on_save(::grmcdorman::WebSettings &web_settings)
 {
-    Serial.println("Saving settings");
-    DynamicJsonDocument json(4096);
-    for (auto &setting: settings)
-    {
-        if (strlen_P(reinterpret_cast<const char *>(setting->name())) != 0 && setting->is_persistable())
-        {
-            json[setting->name()] = setting->as_string();
-        }
-    }
-
-    File configFile = LittleFS.open(FPSTR(config_path), "w");
-    if (!configFile) {
-        return;
-    }
-
-    serializeJson(json, configFile);
-    configFile.close();
+    // The settings journal writes the changes to flash shortly, from `loop()`.
+    Serial.println("Settings saved");
 }
@@ -0,0 +1,262 @@
+#include "grmcdorman/GzipWriter.h"
+
+#include <Arduino.h>
+#include <algorithm>
+
+namespace grmcdorman
+{
+    namespace
+    {
+        // Deflate length codes 257-285: base lengths and extra bits.
+        const uint16_t length_base[] PROGMEM = {
+            3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+            35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+        };
+        const uint8_t length_extra[] PROGMEM = {
+            0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+            3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+        };
+        // Deflate distance codes 0-29: base distances and extra bits.
+        const uint16_t distance_base[] PROGMEM = {
+            1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+            257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+        };
+        const uint8_t distance_extra[] PROGMEM = {
+            0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+            7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+        };
+        // CRC-32 (reflected, polynomial 0xEDB88320), one nibble at a time.
+        const uint32_t crc_table[] PROGMEM = {
+            0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+            0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+        };
+        // gzip header: magic, deflate, no flags, no time, no extra flags, unknown OS.
+        const uint8_t gzip_header[] PROGMEM = { 0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff };
+    }
+
+    GzipWriter::GzipWriter(Print &output):
+        output(output), crc(~0u), input_size(0), output_error(false), bit_buffer(0), bit_count(0),
+        position(0), window_end(0), output_used(0), head(), previous()
+    {
+        for (size_t i = 0; i < sizeof(gzip_header); ++i)
+        {
+            put_byte(pgm_read_byte(&gzip_header[i]));
+        }
+        // A single final block, using the fixed Huffman codes.
+        put_bits(1, 1);
+        put_bits(1, 2);
+    }
+
+    uint32_t GzipWriter::update_crc(uint32_t crc, const uint8_t *data, size_t length)
+    {
+        crc = ~crc;
+        for (size_t i = 0; i < length; ++i)
+        {
+            crc ^= data[i];
+            crc = (crc >> 4) ^ pgm_read_dword(&crc_table[crc & 0x0f]);
+            crc = (crc >> 4) ^ pgm_read_dword(&crc_table[crc & 0x0f]);
+        }
+        return ~crc;
+    }
+
+    void GzipWriter::write(const uint8_t *data, size_t length)
+    {
+        crc = ~update_crc(~crc, data, length);
+        input_size += length;
+        while (length != 0)
+        {
+            if (window_end == sizeof(window))
+            {
+                slide();
+            }
+            size_t count = std::min(length, sizeof(window) - window_end);
+            memcpy(&window[window_end], data, count);
+            window_end += count;
+            data += count;
+            length -= count;
+            compress(false);
+        }
+    }
+
+    bool GzipWriter::finish()
+    {
+        compress(true);
+        put_code(0, 7);     // End of block; symbol 256.
+        if (bit_count != 0)
+        {
+            put_bits(0, 8 - bit_count);
+        }
+        uint32_t final_crc = get_crc();
+        for (int i = 0; i < 4; ++i)
+        {
+            put_byte(static_cast<uint8_t>(final_crc >> (8 * i)));
+        }
+        for (int i = 0; i < 4; ++i)
+        {
+            put_byte(static_cast<uint8_t>(input_size >> (8 * i)));
+        }
+        flush_output();
+        return !output_error;
+    }
+
+    void GzipWriter::slide()
+    {
+        // `compress` always leaves the position beyond the lower half.
+        memmove(window, &window[WINDOW_SIZE], WINDOW_SIZE);
+        position -= WINDOW_SIZE;
+        window_end -= WINDOW_SIZE;
+        for (auto &entry: head)
+        {
+            entry = entry > WINDOW_SIZE ? entry - WINDOW_SIZE : 0;
+        }
+        for (auto &entry: previous)
+        {
+            entry = entry > WINDOW_SIZE ? entry - WINDOW_SIZE : 0;
+        }
+    }
+
+    void GzipWriter::insert_hash(size_t at)
+    {
+        if (at + MIN_MATCH > window_end)
+        {
+            return;
+        }
+        size_t hash = ((window[at] << 6) ^ (window[at + 1] << 3) ^ window[at + 2]) & (HASH_SIZE - 1);
+        previous[at & (WINDOW_SIZE - 1)] = head[hash];
+        head[hash] = static_cast<uint16_t>(at + 1);
+    }
+
+    void GzipWriter::compress(bool flush)
+    {
+        while (position < window_end && (flush || window_end - position >= MAX_MATCH))
+        {
+            size_t available = std::min(window_end - position, MAX_MATCH);
+            size_t best_length = 0;
+            size_t best_distance = 0;
+            if (available >= MIN_MATCH)
+            {
+                size_t hash = ((window[position] << 6) ^ (window[position + 1] << 3) ^ window[position + 2]) & (HASH_SIZE - 1);
+                size_t candidate = head[hash];
+                for (int chain = 0; candidate != 0 && chain < MAX_CHAIN; ++chain)
+                {
+                    size_t start = candidate - 1;
+                    if (start >= position || position - start >= WINDOW_SIZE)
+                    {
+                        break;
+                    }
+                    size_t length = 0;
+                    while (length < available && window[start + length] == window[position + length])
+                    {
+                        ++length;
+                    }
+                    if (length > best_length)
+                    {
+                        best_length = length;
+                        best_distance = position - start;
+                        if (length == available)
+                        {
+                            break;
+                        }
+                    }
+                    candidate = previous[start & (WINDOW_SIZE - 1)];
+                }
+            }
+
+            if (best_length >= MIN_MATCH)
+            {
+                put_match(best_length, best_distance);
+                for (size_t i = 0; i < best_length; ++i)
+                {
+                    insert_hash(position + i);
+                }
+                position += best_length;
+            }
+            else
+            {
+                put_literal(window[position]);
+                insert_hash(position);
+                ++position;
+            }
+        }
+    }
+
+    void GzipWriter::put_bits(uint32_t value, uint8_t count)
+    {
+        bit_buffer |= value << bit_count;
+        bit_count += count;
+        while (bit_count >= 8)
+        {
+            put_byte(static_cast<uint8_t>(bit_buffer));
+            bit_buffer >>= 8;
+            bit_count -= 8;
+        }
+    }
+
+    void GzipWriter::put_code(uint16_t code, uint8_t count)
+    {
+        uint16_t reversed = 0;
+        for (uint8_t i = 0; i < count; ++i)
+        {
+            reversed = (reversed << 1) | (code & 1);
+            code >>= 1;
+        }
+        put_bits(reversed, count);
+    }
+
+    void GzipWriter::put_literal(uint16_t symbol)
+    {
+        if (symbol <= 143)
+        {
+            put_code(0x30 + symbol, 8);
+        }
+        else if (symbol <= 255)
+        {
+            put_code(0x190 + symbol - 144, 9);
+        }
+        else if (symbol <= 279)
+        {
+            put_code(symbol - 256, 7);
+        }
+        else
+        {
+            put_code(0xc0 + symbol - 280, 8);
+        }
+    }
+
+    void GzipWriter::put_match(size_t length, size_t distance)
+    {
+        size_t code = 0;
+        while (code + 1 < sizeof(length_base) / sizeof(length_base[0]) && pgm_read_word(&length_base[code + 1]) <= length)
+        {
+            ++code;
+        }
+        put_literal(257 + code);
+        put_bits(length - pgm_read_word(&length_base[code]), pgm_read_byte(&length_extra[code]));
+
+        code = 0;
+        while (code + 1 < sizeof(distance_base) / sizeof(distance_base[0]) && pgm_read_word(&distance_base[code + 1]) <= distance)
+        {
+            ++code;
+        }
+        put_code(code, 5);
+        put_bits(distance - pgm_read_word(&distance_base[code]), pgm_read_byte(&distance_extra[code]));
+    }
+
+    void GzipWriter::put_byte(uint8_t value)
+    {
+        output_buffer[output_used++] = value;
+        if (output_used == sizeof(output_buffer))
+        {
+            flush_output();
+        }
+    }
+
+    void GzipWriter::flush_output()
+    {
+        if (output_used != 0 && output.write(output_buffer, output_used) != output_used)
+        {
+            output_error = true;
+        }
+        output_used = 0;
+    }
+}
@@ -0,0 +1,155 @@
+#include "grmcdorman/HtmlWriter.h"
+
+#include <Arduino.h>
+
+namespace grmcdorman
+{
+    size_t HtmlWriter::accept(size_t &length)
+    {
+        size_t offset = 0;
+        if (overflow)
+        {
+            length = 0;
+            return 0;
+        }
+
+        if (skip != 0)
+        {
+            if (length <= skip)
+            {
+                // All of this was sent in a previous chunk.
+                skip -= length;
+                length = 0;
+                return 0;
+            }
+            offset = skip;
+            length -= skip;
+            skip = 0;
+        }
+
+        if (length > capacity - used)
+        {
+            length = capacity - used;
+            overflow = true;
+        }
+
+        return offset;
+    }
+
+    void HtmlWriter::write(const char *text, size_t length)
+    {
+        size_t offset = accept(length);
+        if (length != 0)
+        {
+            memcpy(&buffer[used], &text[offset], length);
+            used += length;
+        }
+    }
+
+    void HtmlWriter::write_P(PGM_P text, size_t length)
+    {
+        size_t offset = accept(length);
+        if (length != 0)
+        {
+            memcpy_P(&buffer[used], &text[offset], length);
+            used += length;
+        }
+    }
+
+    void HtmlWriter::write_template_P(const HtmlTemplateLayout *layout, PGM_P text, const HtmlTemplateField *fields)
+    {
+        uint8_t segment_count = pgm_read_byte(&layout->segment_count);
+        size_t start = 0;
+        for (uint8_t i = 0; i < segment_count && !overflow; ++i)
+        {
+            size_t end = pgm_read_word(&layout->segment_end[i]);
+            write_P(&text[start], end - start);
+            uint8_t field = pgm_read_byte(&layout->field[i]);
+            if (field != 0)
+            {
+                write_P(fields[field - 1].text, fields[field - 1].length);
+            }
+            start = end;
+        }
+    }
+
+    void HtmlWriter::write_unsigned(uint32_t value)
+    {
+        char digits[sizeof("4294967295")];
+        utoa(value, digits, 10);
+        write(digits, strlen(digits));
+    }
+
+    void HtmlWriter::write_signed(int32_t value)
+    {
+        char digits[sizeof("-2147483648")];
+        itoa(value, digits, 10);
+        write(digits, strlen(digits));
+    }
+
+    void HtmlWriter::write_json_escaped(const char *text, size_t length)
+    {
+        // Unescaped runs are written in one go.
+        size_t run_start = 0;
+        for (size_t i = 0; i < length && !overflow; ++i)
+        {
+            if (needs_json_escape(text[i]))
+            {
+                write(&text[run_start], i - run_start);
+                write_json_escape(text[i]);
+                run_start = i + 1;
+            }
+        }
+
+        write(&text[run_start], length - run_start);
+    }
+
+    void HtmlWriter::write_json_escaped_P(PGM_P text, size_t length)
+    {
+        size_t run_start = 0;
+        for (size_t i = 0; i < length && !overflow; ++i)
+        {
+            char ch = static_cast<char>(pgm_read_byte(&text[i]));
+            if (needs_json_escape(ch))
+            {
+                write_P(&text[run_start], i - run_start);
+                write_json_escape(ch);
+                run_start = i + 1;
+            }
+        }
+
+        write_P(&text[run_start], length - run_start);
+    }
+
+    void HtmlWriter::write_json_escape(char ch)
+    {
+        static const char hex_digits[] PROGMEM = "0123456789abcdef";
+        char escape[6] = { '\\', ch, '0', '0', '0', '0' };
+        switch (ch)
+        {
+        case '"':
+        case '\\':
+            write(escape, 2);
+            break;
+        case '\n':
+            escape[1] = 'n';
+            write(escape, 2);
+            break;
+        case '\r':
+            escape[1] = 'r';
+            write(escape, 2);
+            break;
+        case '\t':
+            escape[1] = 't';
+            write(escape, 2);
+            break;
+        default:
+            // Other control characters.
+            escape[1] = 'u';
+            escape[4] = static_cast<char>(pgm_read_byte(&hex_digits[(ch >> 4) & 0x0f]));
+            escape[5] = static_cast<char>(pgm_read_byte(&hex_digits[ch & 0x0f]));
+            write(escape, sizeof(escape));
+            break;
+        }
+    }
+}
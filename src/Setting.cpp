@@ -1,6 +1,7 @@
 #include "grmcdorman/Setting.h"
 #include <Arduino.h>
 #include <algorithm>
+#include <cmath>
 
 #include <stddef.h>
 #include <stdarg.h>
@@ -15,107 +16,136 @@ namespace grmcdorman
         const char * PROGMEM NUMBER_STR = "number";
         auto NUMBER = FPSTR(NUMBER_STR);
     }
+
+// Static markup for setting HTML templates; see `SettingInterface::write_html_template`.
+#define HTML_CONTAINER "\x01"
+#define HTML_NAME "\x02"
+#define HTML_DESCRIPTION "\x03"
+#define HTML_UNIQUE_ID HTML_CONTAINER "$" HTML_NAME
+#define HTML_ID_NAME "id=\"" HTML_UNIQUE_ID "\" name=\"" HTML_UNIQUE_ID "\""
+#define HTML_LABEL "<label for=\"" HTML_UNIQUE_ID "\">" HTML_DESCRIPTION "</label>"
+#define HTML_INPUT(type, extra) "<input type=\"" type "\" " HTML_ID_NAME extra " />" HTML_LABEL
+    uint32_t SettingInterface::current_version = 0;
+
     SettingInterface::SettingInterface(const __FlashStringHelper *description, const __FlashStringHelper *setting_name):
         description(description),
-        setting_name(setting_name)
+        setting_name(setting_name),
+        description_length(strlen_P(reinterpret_cast<PGM_P>(description))),
+        name_length(strlen_P(reinterpret_cast<PGM_P>(setting_name))),
+        version(0)
     {
     }
 
-    String SettingInterface::escape_value(const String &value) const
+    HtmlTemplateField SettingInterface::container_field(const __FlashStringHelper *container_name)
     {
-        String escaped_value;
-        escaped_value.reserve(value.length());
-        for (const char ch: value)
+        static const __FlashStringHelper *last_container = nullptr;
+        static size_t last_length = 0;
+        if (container_name != last_container)
         {
-            switch (ch)
-            {
-            case '<':
-                escaped_value += F("&lt;");
-                break;
-            case '>':
-                escaped_value += F("&gt;");
-                break;
-            case '\"':
-                escaped_value += F("&quot;");
-                break;
-            case '&':
-                escaped_value += F("&amp;");
-                break;
-            default:
-                escaped_value += ch;
-                break;
-            }
+            last_container = container_name;
+            last_length = strlen_P(reinterpret_cast<PGM_P>(container_name));
         }
+        return HtmlTemplateField{ reinterpret_cast<PGM_P>(container_name), last_length };
+    }
 
-        return escaped_value;
+    void SettingInterface::write_unique_id(HtmlWriter &writer, const __FlashStringHelper *container_name) const
+    {
+        writer.write(container_name);
+        writer.write('$');
+        writer.write(name());
     }
 
-    String SettingInterface::get_unique_id(const String &container_name) const
+    void SettingInterface::write_id_name_fields(HtmlWriter &writer, const __FlashStringHelper *container_name) const
     {
-        String result(container_name);
-        result += '$';
-        result += name();
-        return result;
+        static const char id_start[] PROGMEM = "id=\"";
+        static const char name_start[] PROGMEM = "\" name=\"";
+        writer.write_P(id_start);
+        write_unique_id(writer, container_name);
+        writer.write_P(name_start);
+        write_unique_id(writer, container_name);
+        writer.write('"');
     }
 
-    String SettingInterface::get_id_name_fields(const String &container_name) const
+    void SettingInterface::write_html_label(HtmlWriter &writer, const __FlashStringHelper *container_name) const
     {
-        String id = get_unique_id(container_name);
-        String result(static_cast<const char *>(nullptr));
-        result.reserve(4 + // id=
-                       2*id.length() +
-                       8 + // " name="
-                       1 // closing quote
-        );
-        result = F("id=\"");
-        result += id;
-        result += F("\" name=\"");
-        result += std::move(id);
-        result += '"';
-        return result;
+        static const char label_start[] PROGMEM = "<label for=\"";
+        static const char label_end[] PROGMEM = "</label>";
+        writer.write_P(label_start);
+        write_unique_id(writer, container_name);
+        writer.write(F("\">"));
+        writer.write(get_description());
+        writer.write_P(label_end);
     }
 
-    String SettingInterface::get_html_label(const String &container_name) const
+    void SettingInterface::write_schema_start(HtmlWriter &writer, const __FlashStringHelper *type) const
     {
-        String result(F("<label for=\""));
-        result += get_unique_id(container_name);
-        result += F("\">");
-        result += get_description();
-        result += F("</label>");
-        return result;
+        static const char type_start[] PROGMEM = "{\"t\":\"";
+        static const char name_start[] PROGMEM = "\",\"n\":\"";
+        static const char description_start[] PROGMEM = "\",\"d\":\"";
+        static const char not_sent[] PROGMEM = ",\"u\":0";
+        writer.write_P(type_start);
+        writer.write(type);
+        writer.write_P(name_start);
+        writer.write_json_escaped(name());
+        writer.write_P(description_start);
+        writer.write_json_escaped(get_description());
+        writer.write('"');
+        if (!send_to_ui())
+        {
+            writer.write_P(not_sent);
+        }
     }
 
-    String SettingInterface::get_make_html(const String &container_name, const String &element_html) const
+    void SettingInterface::write_json_value(HtmlWriter &writer) const
     {
-        String result(element_html);
-        result += get_html_label(container_name);
-        return result;
+        writer.write('"');
+        writer.write_json_escaped(as_string());
+        writer.write('"');
     }
 
-    String SettingInterface::get_make_input(const __FlashStringHelper *type, const String &container_name, const String &value, const __FlashStringHelper *extra) const
+    void SettingInterface::write_json(HtmlWriter &writer) const
     {
-        // Note that while values are reloaded when the tab is selected,
-        // initial values are required so that `save` doesn't get the wrong
-        // data if the tab is never loaded.
-        String result(F("<input type=\""));
-        result += type;
-        result += F("\" ");
-        result += get_id_name_fields(container_name);
-        if (extra != nullptr)
-        {
-            result += extra;
-        }
-        result += F(" />");
-        result += get_html_label(container_name);
-        return result;
+        static const char name_start[] PROGMEM = "{\"name\":\"";
+        static const char value_start[] PROGMEM = "\",\"value\":";
+        writer.write_P(name_start);
+        writer.write_json_escaped(name());
+        writer.write_P(value_start);
+        write_json_value(writer);
+        writer.write('}');
+    }
+
+    void StringSetting::write_html(HtmlWriter &writer, const __FlashStringHelper *container_name) const
+    {
+        static constexpr auto html PROGMEM = make_html_template(HTML_INPUT("text", ""));
+        write_html_template(writer, html, container_name);
+    }
+
+    void StringSetting::write_schema(HtmlWriter &writer) const
+    {
+        write_schema_start(writer, F("text"));
+        writer.write('}');
     }
 
-    String StringSetting::get_html(const String &container_name) const
+    void StringSetting::write_json_value(HtmlWriter &writer) const
     {
-        return get_make_input(F("text"), container_name, escape_value(get()), nullptr);
+        writer.write('"');
+        writer.write_json_escaped(get());
+        writer.write('"');
     }
 
-    String PasswordSetting::get_html(const String &container_name) const
+    bool StringSetting::set_from_stored(StorageType type, const void *data, size_t length)
+    {
+        if (type != StorageType::STRING)
+        {
+            return false;
+        }
+        String new_value;
+        new_value.concat(static_cast<const char *>(data), length);
+        set(new_value);
+        return true;
+    }
+
+    void PasswordSetting::write_html(HtmlWriter &writer, const __FlashStringHelper *container_name) const
     {
         // A password is very special.
         // In UI terms, the user can:
@@ -127,35 +157,54 @@ namespace grmcdorman
         // The solution, below, is to have the field disabled by default;
         // if checked, the field will become enabled, the user can enter values,
         // and it will be submitted.
-        String result(F("<span class=\"password_group\">"));
-        result += F("<input type=\"checkbox\" id=\"");
-        result += container_name;
-        result += F("$pw$");
-        result += name();
-        result += F("\" onchange='"
-            "document.getElementById(\"");
-        result += get_unique_id(container_name);
-        result += F("\").disabled = !event.target.checked;"
+        static constexpr auto html PROGMEM = make_html_template(
+            "<span class=\"password_group\">"
+            "<input type=\"checkbox\" id=\"" HTML_CONTAINER "$pw$" HTML_NAME "\" onchange='"
+            "document.getElementById(\"" HTML_UNIQUE_ID "\").disabled = !event.target.checked;"
             "'"
-            "><input type=\"password\" ");
-        result += get_id_name_fields(container_name);
-        result += F(" disabled=\"true\"></span>");
-        result += get_html_label(container_name);
-        return result;
+            "><input type=\"password\" " HTML_ID_NAME " disabled=\"true\"></span>"
+            HTML_LABEL);
+        write_html_template(writer, html, container_name);
+    }
+
+    void PasswordSetting::write_schema(HtmlWriter &writer) const
+    {
+        write_schema_start(writer, F("password"));
+        writer.write('}');
+    }
+
+    void SignedIntegerSetting::write_html(HtmlWriter &writer, const __FlashStringHelper *container_name) const
+    {
+        static constexpr auto html PROGMEM = make_html_template(HTML_INPUT("number", ""));
+        write_html_template(writer, html, container_name);
     }
 
-    String SignedIntegerSetting::get_html(const String &container_name) const
+    void SignedIntegerSetting::write_schema(HtmlWriter &writer) const
     {
-        return get_make_input(NUMBER, container_name, String(get()), nullptr);
+        write_schema_start(writer, NUMBER);
+        writer.write('}');
     }
 
-    String NoteSetting::get_html(const String &) const
+    void SignedIntegerSetting::write_json_value(HtmlWriter &writer) const
     {
-        String result(F("<div class=\"note\">"));
-        result += get();
-        static const char * PROGMEM DIV_END = "</div>";
-        result += FPSTR(DIV_END);
-        return result;
+        writer.write_signed(get());
+    }
+
+    void NoteSetting::write_html(HtmlWriter &writer, const __FlashStringHelper *) const
+    {
+        static const char div_start[] PROGMEM = "<div class=\"note\">";
+        static const char div_end[] PROGMEM = "</div>";
+        writer.write_P(div_start);
+        writer.write(get());
+        writer.write_P(div_end);
+    }
+
+    void NoteSetting::write_schema(HtmlWriter &writer) const
+    {
+        static const char note_start[] PROGMEM = "{\"t\":\"note\",\"d\":\"";
+        writer.write_P(note_start);
+        writer.write_json_escaped(get());
+        writer.write(F("\"}"));
     }
 
     void SignedIntegerSetting::set_from_string(const String &new_value)
@@ -164,9 +213,21 @@ namespace grmcdorman
         set(static_cast<value_type>(new_value.toInt()));
     }
 
-    String UnsignedIntegerSetting::get_html(const String &container_name) const
+    void UnsignedIntegerSetting::write_html(HtmlWriter &writer, const __FlashStringHelper *container_name) const
     {
-        return get_make_input(NUMBER, container_name, String(get()), F(" min=\"0\""));
+        static constexpr auto html PROGMEM = make_html_template(HTML_INPUT("number", " min=\"0\""));
+        write_html_template(writer, html, container_name);
+    }
+
+    void UnsignedIntegerSetting::write_schema(HtmlWriter &writer) const
+    {
+        write_schema_start(writer, NUMBER);
+        writer.write(F(",\"min\":0}"));
+    }
+
+    void UnsignedIntegerSetting::write_json_value(HtmlWriter &writer) const
+    {
+        writer.write_unsigned(get());
     }
 
     void UnsignedIntegerSetting::set_from_string(const String &new_value)
@@ -175,9 +236,31 @@ namespace grmcdorman
         set(static_cast<value_type>(std::strtoul(new_value.c_str(), nullptr, 10)));
     }
 
-    String FloatSetting::get_html(const String &container_name) const
+    void FloatSetting::write_html(HtmlWriter &writer, const __FlashStringHelper *container_name) const
+    {
+        static constexpr auto html PROGMEM = make_html_template(HTML_INPUT("number", " step=\"0.1\""));
+        write_html_template(writer, html, container_name);
+    }
+
+    void FloatSetting::write_schema(HtmlWriter &writer) const
+    {
+        write_schema_start(writer, NUMBER);
+        writer.write(F(",\"step\":0.1}"));
+    }
+
+    void FloatSetting::write_json_value(HtmlWriter &writer) const
     {
-        return get_make_input(NUMBER, container_name, String(get()), F(" step=\"0.1\""));
+        if (!std::isfinite(get()))
+        {
+            // JSON has no representation for these.
+            writer.write(F("null"));
+            return;
+        }
+
+        // Two decimal digits, as for `as_string()`. The largest float is 39 digits.
+        char digits[48];
+        dtostrf(get(), 1, 2, digits);
+        writer.write(digits, strlen(digits));
     }
 
     void FloatSetting::set_from_string(const String &new_value)
@@ -185,33 +268,77 @@ namespace grmcdorman
         set(new_value.toFloat());
     }
 
-    String ExclusiveOptionSetting::get_html(const String &container_name) const
+    void ExclusiveOptionSetting::write_html(HtmlWriter &writer, const __FlashStringHelper *container_name) const
     {
-        String id(get_unique_id(container_name));
-        String result(F("<select "));
-        result += get_id_name_fields(container_name);
-        result += F(" \">");
+        static const char select_start[] PROGMEM = "<select ";
+        static const char select_start_end[] PROGMEM = " \">";
+        static const char option_start[] PROGMEM = "<option name=\"";
+        static const char selected[] PROGMEM = " selected";
+        static const char option_end[] PROGMEM = "</option>";
+        static const char select_end[] PROGMEM = "</select>";
+        writer.write_P(select_start);
+        write_id_name_fields(writer, container_name);
+        writer.write_P(select_start_end);
         uint16_t index = 0;
         for (const auto &option: names)
         {
             ++index;
-            result += F("<option name=\"");
-            result += id;
-            result += F("_");
-            result += index;
-            result += F("\"");
+            writer.write_P(option_start);
+            write_unique_id(writer, container_name);
+            writer.write('_');
+            writer.write_unsigned(index);
+            writer.write('"');
             if (index == get() + 1)
             {
-                result += F(" selected");
+                writer.write_P(selected);
+            }
+            writer.write('>');
+            writer.write(option);
+            writer.write_P(option_end);
+            if (writer.overflowed())
+            {
+                // No point formatting the remaining options.
+                break;
             }
-            result += F(">");
-            result += option;
-            result += F("</option>");
         }
-        result += F("</select>");
-        result += get_html_label(container_name);
-        return result;
-   }
+        writer.write_P(select_end);
+        write_html_label(writer, container_name);
+    }
+
+    void ExclusiveOptionSetting::write_schema(HtmlWriter &writer) const
+    {
+        static const char options_start[] PROGMEM = ",\"o\":[";
+        write_schema_start(writer, F("select"));
+        writer.write_P(options_start);
+        bool first = true;
+        for (const auto &option: names)
+        {
+            if (!first)
+            {
+                writer.write(',');
+            }
+            first = false;
+            writer.write('"');
+            writer.write_json_escaped(option);
+            writer.write('"');
+            if (writer.overflowed())
+            {
+                // No point formatting the remaining options.
+                break;
+            }
+        }
+        writer.write(F("]}"));
+    }
+
+    void ExclusiveOptionSetting::write_json_value(HtmlWriter &writer) const
+    {
+        writer.write('"');
+        if (!names.empty())
+        {
+            writer.write_json_escaped(names[std::min(static_cast<size_t>(get()), names.size() - 1)]);
+        }
+        writer.write('"');
+    }
 
     void ExclusiveOptionSetting::set_from_string(const String &new_value)
     {
@@ -226,9 +353,21 @@ namespace grmcdorman
         return names[std::max(static_cast<value_type>(0), std::min(static_cast<value_type>(names.size()), get()))];
     }
 
-    String ToggleSetting::get_html(const String &container_name) const
+    void ToggleSetting::write_html(HtmlWriter &writer, const __FlashStringHelper *container_name) const
+    {
+        static constexpr auto html PROGMEM = make_html_template(HTML_INPUT("checkbox", ""));
+        write_html_template(writer, html, container_name);
+    }
+
+    void ToggleSetting::write_schema(HtmlWriter &writer) const
+    {
+        write_schema_start(writer, F("checkbox"));
+        writer.write('}');
+    }
+
+    void ToggleSetting::write_json_value(HtmlWriter &writer) const
     {
-        return get_make_input(F("checkbox"), container_name, "", nullptr);
+        writer.write(get() ? F("true") : F("false"));
     }
 
     void ToggleSetting::set_from_string(const String &new_value)
@@ -238,22 +377,79 @@ namespace grmcdorman
             new_value == "1");
     }
 
-    String InfoSettingHtml::get_html(const String &container_name) const
+    void InfoSettingHtml::write_html(HtmlWriter &writer, const __FlashStringHelper *container_name) const
     {
-        String result(F("<span class=\"info\" "));
-        result += get_id_name_fields(container_name);
-        result += '>';
-        result += F("</span>");
-        result += get_html_label(container_name);
-        return result;
-   }
+        static constexpr auto html PROGMEM = make_html_template("<span class=\"info\" " HTML_ID_NAME "></span>" HTML_LABEL);
+        write_html_template(writer, html, container_name);
+    }
 
-    String InfoSettingHtml::as_string() const
+    void InfoSettingHtml::write_schema(HtmlWriter &writer) const
     {
-        if (request_callback != nullptr)
+        write_schema_start(writer, F("info"));
+        writer.write('}');
+    }
+
+    void InfoSettingHtml::prepare_to_send() const
+    {
+        if (!background_refresh && is_stale())
         {
-            request_callback(*this);
+            refresh();
         }
+    }
+
+    InfoSettingHtml::~InfoSettingHtml()
+    {
+        set_background_refresh(false);
+    }
+
+    void InfoSettingHtml::set_background_refresh(bool enable)
+    {
+        auto &settings = background_settings();
+        if (enable && !background_refresh)
+        {
+            settings.push_back(this);
+        }
+        else if (!enable && background_refresh)
+        {
+            settings.erase(std::remove(settings.begin(), settings.end(), this), settings.end());
+        }
+        background_refresh = enable;
+    }
+
+    void InfoSettingHtml::refresh_in_background()
+    {
+        // Indexed, as a callback may enable or disable background refresh.
+        auto &settings = background_settings();
+        for (size_t i = 0; i < settings.size(); ++i)
+        {
+            if (settings[i]->is_stale())
+            {
+                settings[i]->refresh();
+            }
+        }
+    }
+
+    std::vector<InfoSettingHtml *> &InfoSettingHtml::background_settings()
+    {
+        static std::vector<InfoSettingHtml *> settings;
+        return settings;
+    }
+
+    bool InfoSettingHtml::is_stale() const
+    {
+        return request_callback != nullptr && (!refreshed || max_age == 0 || millis() - last_refresh >= max_age);
+    }
+
+    void InfoSettingHtml::refresh() const
+    {
+        request_callback(*this);
+        last_refresh = millis();
+        refreshed = true;
+    }
+
+    String InfoSettingHtml::as_string() const
+    {
+        prepare_to_send();
         return get();
     }
 }
\ No newline at end of file
@@ -1,16 +1,12 @@
 #include "grmcdorman/SettingPanel.h"
 
 #include <algorithm>
-#include <ArduinoJson.h>
 
+#include "grmcdorman/NameHash.h"
 #include "grmcdorman/Setting.h"
 
 namespace grmcdorman
 {
-    namespace {
-        const char * PROGMEM NAME_STR = "name";
-        const char * PROGMEM VALUE_STR = "value";
-    }
     SettingPanel::SettingPanel(const __FlashStringHelper *name, const __FlashStringHelper *identifier, const SettingInterface::settings_list_t &settings_set):
         name(name),
         name_length(strlen_P(reinterpret_cast<const char *>(name))),
@@ -20,68 +16,40 @@ namespace grmcdorman
     {
     }
 
-    DynamicJsonDocument SettingPanel::as_json(const std::vector<const String *> &requested_settings) const
+    bool SettingPanel::is_sent(const SettingInterface &setting, const requested_settings_t &requested_settings)
     {
-        if (settings.size() == 0)
+        auto name = reinterpret_cast<PGM_P>(setting.name());
+        if (pgm_read_byte(name) == '\0' || !setting.send_to_ui())
         {
-            DynamicJsonDocument doc(JSON_ARRAY_SIZE(1));
-            doc.to<JsonArray>();
-            return doc;
+            return false;
         }
-
-        // Sizing is critical here. Too small, and the document is incomplete;
-        // too large, and it may not allocate at all - also resulting in an
-        // incomplete document. Short of ad-hoc text as JSON or other hacks
-        // to perform chunked output, this is not really scalable.
-        bool all = requested_settings.empty();
-        size_t stateSize = JSON_ARRAY_SIZE(settings.size()) + 512 * settings.size();
-        DynamicJsonDocument doc(stateSize);
-        JsonArray array = doc.to<JsonArray>();
-
-        for(auto &setting: settings)
+        if (requested_settings.empty())
         {
-            auto len = strlen_P(reinterpret_cast<const char *>(setting->name()));
-            if (len == 0 || !setting->send_to_ui())
-            {
-                continue;
-            }
+            return true;
+        }
 
-            if (!all)
+        uint32_t hash = name_hash::update_P(name_hash::basis, name);
+        auto requested = std::lower_bound(requested_settings.begin(), requested_settings.end(), hash, [] (const RequestedSetting &r, uint32_t h)
+        {
+            return r.hash < h;
+        });
+        for (; requested != requested_settings.end() && requested->hash == hash; ++requested)
+        {
+            if (strcmp_P(requested->name.c_str(), name) == 0)
             {
-                if (!std::any_of(requested_settings.begin(), requested_settings.end(), [setting] (const String *s)
-                    {
-                        return strcmp_P(s->c_str(), reinterpret_cast<const char *>(setting->name())) == 0;
-                    }))
-                {
-                    continue;
-                }
+                return true;
             }
-
-            auto value = setting->as_string();
-            DynamicJsonDocument valueJson(len + value.length() + 128);
-            valueJson[FPSTR(NAME_STR)] = setting->name();
-            valueJson[FPSTR(VALUE_STR)] = value;
-            array.add(valueJson);
         }
-
-        return doc;
+        return false;
     }
 
-    void SettingPanel::on_post(AsyncWebServerRequest *request)
+    void SettingPanel::add_requested_setting(requested_settings_t &requested_settings, const String &name)
     {
-        for(auto &setting: settings)
+        uint32_t hash = name_hash::hash(name.c_str(), name.length());
+        auto position = std::upper_bound(requested_settings.begin(), requested_settings.end(), hash, [] (uint32_t h, const RequestedSetting &r)
         {
-            String argName(get_identifier());
-            argName += '$';
-            argName += setting->name();
-            if (request->hasArg(argName.c_str()))
-            {
-                setting->set_from_post(request->arg(argName));
-            }
-            else if (setting->send_to_ui())
-            {
-                setting->set_default();
-            }
-        }
+            return h < r.hash;
+        });
+        requested_settings.insert(position, RequestedSetting{ hash, name });
     }
 }
\ No newline at end of file
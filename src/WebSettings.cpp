@@ -1,11 +1,18 @@
 
 #include "grmcdorman/WebSettings.h"
 
-#include <AsyncJson.h>
+#include <algorithm>
+#include <new>
+
 #include <LittleFS.h>
+#include <user_interface.h>
 #include <WebAuthentication.h>
 
+#include "grmcdorman/GzipWriter.h"
+#include "grmcdorman/HtmlWriter.h"
+#include "grmcdorman/NameHash.h"
 #include "grmcdorman/SettingPanel.h"
+#include "grmcdorman/WebAssets.h"
 
 namespace grmcdorman
 {
@@ -17,352 +24,378 @@ namespace grmcdorman
         auto TEXT_JSON = FPSTR(TEXT_JSON_STR);
         const char * PROGMEM TEXT_PLAIN_STR = "text/plain";
         auto TEXT_PLAIN = FPSTR(TEXT_PLAIN_STR);
+        const char * PROGMEM TEXT_CSS_STR = "text/css";
+        auto TEXT_CSS = FPSTR(TEXT_CSS_STR);
+        const char * PROGMEM TEXT_JAVASCRIPT_STR = "text/javascript";
+        auto TEXT_JAVASCRIPT = FPSTR(TEXT_JAVASCRIPT_STR);
+        const char * PROGMEM TEXT_METRICS_STR = "text/plain; version=0.0.4";
+        auto TEXT_METRICS = FPSTR(TEXT_METRICS_STR);
         const char * PROGMEM TEXT_END_DIV_STR = "</div>";
         auto TEXT_END_DIV = FPSTR(TEXT_END_DIV_STR);
         const char * PROGMEM status_div = "<div class=\"status\">";
-        //!< The style sheet. This could be stored gzipp'd to save space
-        //!< and sent to the client that way.
-        const char style[] PROGMEM =
-            ".tab {"
-                "overflow: hidden;"
-                "border: 1px solid #ccc;"
-                "background-color: #f1f1f1;"
-            "}"
-            ".tab button {"
-                "background-color: inherit;"
-                "float: left;"
-                "border: none;"
-                "outline: none;"
-                "cursor: pointer;"
-                "padding: 14px 16px;"
-                "transition: 0.3s;"
-                "font-size: 12pt;"
-            "}"
-            ".tab button:hover {"
-                "background-color: #ddd;"
-            "}"
-            ".tab button.active {"
-                "background-color: #ccc;"
-            "}"
-
-            ".md_button {"
-                "margin-top: -30px;"
-                "position: relative;"
-                "overflow: hidden;"
-                "-webkit-transition: background 400ms;"
-                "transition: background 400ms;"
-                "color: #fff;"
-                "background-color: #0066ff;"
-                "padding: 0.25em 0.5em;"
-                "font-family: 'Roboto', sans-serif;"
-                "font-size: 1rem;"
-                "outline: 0;"
-                "border: 0;"
-                "border-radius: 0.25rem;"
-                "-webkit-box-shadow: 0 0 0.5rem rgba(0, 0, 0, 0.3);"
-                "box-shadow: 0 0 0.5rem rgba(0, 0, 0, 0.3);"
-                "cursor: pointer;"
-                "margin: 0.25em;"
-                "box-sizing: content-box;"
-                "text-decoration:none;"
-            "}"
-
-            ".ripple {"
-                "background-position: center;"
-                "-webkit-transition: background 0.8s;"
-                "transition: background 0.8s;"
-            "}"
-
-            ".ripple:hover {"
-                "background: #3385ff radial-gradient(circle, transparent 1%, #3385ff 1%) center/15000%;"
-            "}"
-
-            ".ripple:active {"
-                "background-color: #4d94ff;"
-                "background-size: 100%;"
-                "-webkit-transition: background 0s;"
-                "transition: background 0s;"
-            "}"
-
-            ".md_button.red {"
-                "background-color: #ff3300;"
-            "}"
-            ".ripple.red:hover {"
-                "background: #ff3300 radial-gradient(circle, transparent 1%, #ff3300 1%) center/15000%;"
-            "}"
-            ".ripple.red:active {"
-                "background-color: #ff5c33;"
-            "}"
-
-            ".status {"
-                "padding:20px;"
-                "margin:20px 0;"
-                "border:1px solid #eee;"
-                "border-left-width:5px;"
-                "border-left-color:#777;"
-            "}"
-
-            ".disable_overlay {"
-                "position: fixed;"
-                "top: 0;"
-                "right: 0;"
-                "bottom: 0;"
-                "left: 0;"
-                "background-color:#000;"
-                "opacity: .75;"
-                "z-index: 9999999;"
-                "display: none;"
-            "}"
-
-            ".tabcontent {"
-                "display: none;"
-                "padding: 6px 12px;"
-                "border: 1px solid #ccc;"
-                "border-top: none;"
-                "margin-left: auto;"
-                "margin-right: auto;"
-            "}"
-            ".tabcontent > input, .tabcontent > select, .tabcontent > span {"
-                "clear: both;"
-                "float: right;"
-                "width: 70%;"
-            "}"
-            ".tabcontent > label {"
-                "float: left;"
-                "width: 25%;"
-                "text-align: right;"
-                "padding: 0.25em 1em 0 0;"
-            "}"
-            ".tabcontent > input[type=\"checkbox\"] {"
-                "width: auto;"
-                "float: left;"
-                "margin: 0.5em 0.5em 0 30%;"
-            "}"
-            ".tabcontent > input[type=\"checkbox\"] + label {"
-                "width: auto;"
-                "text-align: left;"
-            "}"
-            ".password_group > input[type=\"checkbox\"] {"
-                "float: left;"
-            "}"
-            ".password_group > input[type=\"password\"] {"
-                "width: calc(100% - 35px);"
-                "float: right;"
-            "}"
-            ".tabcontent.active {"
-                "display: block;"
-            "}"
-            "@supports (display: grid) {"
-                ".tabcontent.active {"
-                    "display: grid;"
-                "}"
-
-                ".tabcontent {"
-                    "grid-template-columns: 1fr 1em 3fr;"
-                    "grid-gap: 0.3em 0.6em;"
-                    "grid-auto-flow: dense;"
-                    "align-items: center;"
-                "}"
-
-                ".tabcontent > div {"
-                    "grid-column: 1 /4;"
-                    "width: auto;"
-                    "margin: 0;"
-                "}"
-                ".tabcontent > input, .tabcontent > select, .tabcontent > span {"
-                    "grid-column: 2 / 4;"
-                    "width: auto;"
-                    "margin: 0;"
-                "}"
-
-                ".tabcontent > select {"
-                    "margin-right: auto;"
-                "}"
-
-                ".tabcontent > input[type=\"checkbox\"] {"
-                    "grid-column: 1 / 3;"
-                    "justify-self: end;"
-                    "margin: 0;"
-                "}"
-
-                ".tabcontent > label, .tabcontent > input[type=\"checkbox\"] + label {"
-                    "width: auto;"
-                    "padding: 0;"
-                    "margin: 0;"
-                "}"
-            "}"
-        ;
-
-        //!< The Javascript sheet. This could be stored gzipp'd to save space
-        //!< and sent to the client that way. At the moment this includes newlines
-        //!< to allow debugging in the browser.
-        const char javascript_text[] PROGMEM =
-            "function openTab(evt, tabName) {\n"
-                "var i, tabcontent, tablinks;\n"
-                "tabcontent = document.getElementsByClassName(\"tabcontent\");\n"
-                "for (i = 0; i < tabcontent.length; i++) {\n"
-                    "tabcontent[i].className = tabcontent[i].className.replace(\" active\", \"\").replace(\" hidden\", \"\") +"\
-                        "(tabcontent[i].id === tabName ? \" active\" : \" hidden\");\n"
-                "}\n"
-                "tablinks = document.getElementsByClassName(\"tablinks\");\n"
-                "for (i = 0; i < tablinks.length; i++) {\n"
-                    "tablinks[i].className = tablinks[i].className.replace(\" active\", \"\");\n"
-                "}\n"
-                "evt.currentTarget.className += \" active\";\n"
-            "}\n"
-
-            "var globalTabsToLoad = [];\n"
-            "function reloadAllTabs() {\n"
-                "var tabcontent = document.getElementsByClassName(\"tabcontent\");\n"
-                "for (i = 0; i < tabcontent.length; i++) {\n"
-                    "globalTabsToLoad.push(tabcontent[i].id);\n"
-                "}\n"
-                "loadNextTab();\n"
-            "}\n"
-
-            "function loadNextTab() {\n"
-                "if (globalTabsToLoad.length === 0)\n"
-                "{"
-                    "return;"
-                "}"
-                "var tabToLoad = globalTabsToLoad.pop();"
-                "var req = new XMLHttpRequest();\n"
-                "req.overrideMimeType(\"application/json\");\n"
-                "req.open(\"GET\", \"/settings/get?tab=\" + tabToLoad, true);\n"
-                "req.onload = handleSettingsGet;\n"
-                "req.send(null);\n"
-            "}\n"
-
-            "function handleSettingsGet() {\n"
-                "var r = JSON.parse(this.responseText),\n"
-                    "k = Object.keys(r);\n"
-                "for (var i = 0; i < k.length; ++i)\n"
-                "{"
-                    "for (var j = 0; j < r[k[i]].length; ++j)\n"
-                    "{"
-                        "setControlValue(k[i], r[k[i]][j]);\n"
-                    "}\n"
-                "}\n"
-                "setTimeout(loadNextTab, 500);\n"
-            "}\n"
-
-            "function reloadTab(t) {\n"
-                "globalTabsToLoad = [t];\n"
-                "setTimeout(loadNextTab, 500);\n"
-            "}\n"
-
-            "function setControlValue(t, json) {\n"
-                "var element = document.getElementById(t + \"$\" + json.name),\n"
-                    "tag,\n"
-                    "type;\n"
-                "if (element === null) {\n"     // Could be a note. Not updated (usually).
-                    "return;\n"
-                "}\n"
-                "tag = element.tagName.toUpperCase();\n"
-                "if (element.type !== undefined) {\n"
-                    "type = element.type.toUpperCase() ;\n"
-                "}\n"
-                "if (tag === \"DIV\" || tag === \"SPAN\") {\n"
-                    "element.innerHTML = json.value;"
-                "} else if (tag === \"INPUT\" && type == \"NUMBER\") {\n"
-                    "element.value = parseFloat(json.value);\n"
-                "} else if (tag === \"INPUT\" && type == \"CHECKBOX\") {\n"
-                    "element.checked = parseInt(json.value);\n"
-                "} else {\n"
-                    "element.value = json.value;\n"
-                "}\n"
-            "}\n"
-
-            "window.addEventListener(\"load\", reloadAllTabs);\n"
-
-            "function sendData(name) {\n"
-                "document.getElementById(\"disable_overlay\").style.display = \"block\";"
-                "var XHR = new XMLHttpRequest(),\n"
-                "form = document.getElementById(name + \"_form\"),\n"
-                "FD = new FormData( form );\n"
-                "XHR.addEventListener(\"load\", function(event) {\n"
-                    "if (this.status == 200)\n"
-                    "{\n"
-                        "alert(\"Saved settings\");\n"
-                    "}\n"
-                    "else if (this.status == 401)\n"
-                    "{"
-                        "alert(\"Settings not saved, authentication failed\");\n"
-                    "}"
-                    "else\n"
-                    "{"
-                        "alert(\"Settings not saved, server response: \" + this.statusText);\n"
-                    "}"
-                    "document.getElementById(\"disable_overlay\").style.display = \"none\";"
-                "});\n"
-                "XHR.addEventListener(\"error\", function( event ) {\n"
-                    "alert(\"Submitting settings failed\");\n"
-                    "document.getElementById(\"disable_overlay\").style.display = \"none\";"
-                "});"
-                "XHR.open(\"POST\", \"/\" + name + \"/set\");\n"
-                "XHR.send( FD );\n"
-            "}"
-
-            "var periodicUpdateList = [];"
-
-            // Update only the active tab, to minimize load.
-            // Should work in Chrome, IE 9.0+, Edge, Firefox, Safari, Opera.
-            "function periodicUpdate() {\n"
-                "if (periodicUpdateList.length !== 0)\n"
-                "{\n"
-                    "var activeTab = document.getElementsByClassName(\"tabcontent active\")[0].id;\n"
-                    "for (var i = 0; i < periodicUpdateList.length; ++i)\n"
-                    "{"
-                        "if (periodicUpdateList[i].substring(0, activeTab.length + 1) === (activeTab + \"&\") ||"
-                            "periodicUpdateList[i] == activeTab)\n"
-                        "{"
-                            "globalTabsToLoad.push(periodicUpdateList[i]);"
-                        "}"
-                    "}"
-                    "setTimeout(loadNextTab, 500);\n"
-                "}\n"
-            "}\n"
-
-            "setInterval(periodicUpdate, 5000);\n"
-
-            "function factoryReset() {\n"
-                "if (confirm(\"Reset all to factory defaults: this will erase all settings, including WiFi\\n.Are you sure?\")) {"
-                    "document.location = \"/factoryreset?confirm=true\";\n"
-                "}"
-            "}";
-    }
+        const char page_cache_path[] PROGMEM = "/web_settings.html.gz";         //!< The cached, compressed main page.
+        const char page_cache_temp_path[] PROGMEM = "/web_settings.html.tmp";   //!< The main page cache while being written.
+        constexpr size_t page_cache_chunk_size = 1024;                          //!< Chunk size used when rendering the page cache.
+        const char storage_magic[] PROGMEM = "WSET";                           //!< The start of a settings file.
+        constexpr uint8_t storage_format_version = 2;                           //!< The settings file format version.
+        constexpr size_t storage_header_size = 8;                               //!< Settings file header: magic, version, 3 reserved bytes.
+        constexpr size_t storage_segment_size = 8;                              //!< Settings file segment header: length and CRC of the records.
+        constexpr size_t storage_record_size = 7;                               //!< Settings file record header: key, type, value length.
+        constexpr uint32_t snapshot_rtc_offset = 32;                            //!< The restart snapshot position in RTC user memory, in 4-byte blocks; OTA uses the first 128 bytes.
+        constexpr size_t snapshot_size = 384;                                   //!< The space for the restart snapshot in RTC user memory.
+
+        //!< A strong entity tag: a hash as eight hex digits, in quotes.
+        struct EntityTag
+        {
+            char text[11];      //!< The quoted tag, null-terminated.
 
-    /**
-     * @brief This templated function copies chunks of a string array to the buffer.
-     *
-     * It is used both when sending the main page and when sending the style sheet and JavaScript.
-     *
-     * @tparam N                        The array size; inferred from the arguments.
-     * @param[in,out] buffer            The output buffer.
-     * @param maxLen                    The maximum buffer size.
-     * @param[in,out] size              On call, the used size of the buffer. Updated to the total consumed size on return.
-     * @param string_buffer             The string array being sent.
-     * @param[in,out] sent_static_size  The amount of the static string sent so far.
-     * @return true     All data in the string has been copied to the buffer.
-     * @return false    There is yet more data in the string to be copied to the buffer. Another chunk must be sent.
-     */
-    template<size_t N>
-    bool send_static_string(uint8_t *buffer, size_t maxLen, size_t &size, const char (&string_buffer)[N], size_t &sent_static_size)
-    {
-        size_t remaining = N - sent_static_size - 1;
-        if (remaining == 0)
+            //!< The hash as eight hex digits, without quotes; not null-terminated.
+            const char *version() const
+            {
+                return &text[1];
+            }
+        };
+
+        //!< Build an entity tag at compile time.
+        constexpr EntityTag make_entity_tag(uint32_t hash)
+        {
+            EntityTag tag{};
+            tag.text[0] = '"';
+            for (int i = 0; i < 8; ++i)
+            {
+                uint8_t nibble = (hash >> (28 - 4 * i)) & 0x0f;
+                tag.text[1 + i] = static_cast<char>(nibble < 10 ? '0' + nibble : 'a' + nibble - 10);
+            }
+            tag.text[9] = '"';
+            tag.text[10] = '\0';
+            return tag;
+        }
+
+        /**
+         * @brief Compute the hash of the start of a panel's field names.
+         *
+         * Field names are `identifier$` for the panel marker, and `identifier$name` for settings;
+         * continue the hash with the setting name for a setting.
+         *
+         * @param panel     The panel.
+         * @return The hash of the identifier and `$`.
+         */
+        uint32_t field_prefix_hash(const SettingPanel &panel)
+        {
+            return name_hash::update(name_hash::update_P(name_hash::basis, reinterpret_cast<PGM_P>(panel.get_identifier())), '$');
+        }
+
+        //!< Store a 32-bit value, little-endian.
+        void put_uint32(uint8_t *buffer, uint32_t value)
+        {
+            for (int i = 0; i < 4; ++i)
+            {
+                buffer[i] = static_cast<uint8_t>(value >> (8 * i));
+            }
+        }
+
+        //!< Read a little-endian 32-bit value.
+        uint32_t get_uint32(const uint8_t *buffer)
+        {
+            return buffer[0] | (buffer[1] << 8) | (buffer[2] << 16) | (static_cast<uint32_t>(buffer[3]) << 24);
+        }
+
+        /**
+         * @brief Verify the CRC of part of a file.
+         *
+         * The file is returned to its original position.
+         *
+         * @param file      The file, positioned at the start of the data.
+         * @param length    The length of the data.
+         * @param crc       The expected CRC.
+         * @param buffer    A buffer for reading.
+         * @param size      The size of `buffer`.
+         * @return `true` if the data was read and the CRC matches.
+         */
+        bool check_file_crc(File &file, uint32_t length, uint32_t crc, uint8_t *buffer, size_t size)
+        {
+            size_t start = file.position();
+            uint32_t file_crc = 0;
+            for (uint32_t remaining = length; remaining != 0; )
+            {
+                size_t count = std::min<size_t>(remaining, size);
+                if (file.read(buffer, count) != count)
+                {
+                    return false;
+                }
+                file_crc = GzipWriter::update_crc(file_crc, buffer, count);
+                remaining -= count;
+            }
+            return file_crc == crc && file.seek(start, SeekSet);
+        }
+
+        //!< A `Print` that fills a buffer; writes that do not fit are refused.
+        class BufferPrint: public Print
+        {
+        public:
+            BufferPrint(uint8_t *buffer, size_t capacity): buffer(buffer), capacity(capacity), used(0)
+            {
+            }
+
+            size_t write(uint8_t value) override
+            {
+                return write(&value, 1);
+            }
+
+            size_t write(const uint8_t *data, size_t length) override
+            {
+                if (length > capacity - used)
+                {
+                    return 0;
+                }
+                memcpy(&buffer[used], data, length);
+                used += length;
+                return length;
+            }
+
+            //!< The number of bytes written.
+            size_t size() const
+            {
+                return used;
+            }
+
+        private:
+            uint8_t *buffer;        //!< The output buffer.
+            size_t capacity;        //!< The capacity of `buffer`.
+            size_t used;            //!< Bytes written to `buffer`.
+        };
+
+        // Metric endpoint labels, in `MetricsEndpoint` order.
+        const char metrics_label_main_page[] PROGMEM = "endpoint=\"/\",method=\"GET\"";
+        const char metrics_label_style_css[] PROGMEM = "endpoint=\"/style.css\",method=\"GET\"";
+        const char metrics_label_script_js[] PROGMEM = "endpoint=\"/script.js\",method=\"GET\"";
+        const char metrics_label_settings_set[] PROGMEM = "endpoint=\"/settings/set\",method=\"POST\"";
+        const char metrics_label_settings_get[] PROGMEM = "endpoint=\"/settings/get\",method=\"GET\"";
+        const char metrics_label_settings_schema[] PROGMEM = "endpoint=\"/settings/schema\",method=\"GET\"";
+        const char metrics_label_reboot[] PROGMEM = "endpoint=\"/reboot\",method=\"GET\"";
+        const char metrics_label_factory_reset[] PROGMEM = "endpoint=\"/factoryreset\",method=\"GET\"";
+        const char metrics_label_upload_page[] PROGMEM = "endpoint=\"/upload\",method=\"GET\"";
+        const char metrics_label_upload[] PROGMEM = "endpoint=\"/upload\",method=\"POST\"";
+        PGM_P const metrics_endpoint_labels[] PROGMEM = {
+            metrics_label_main_page, metrics_label_style_css, metrics_label_script_js, metrics_label_settings_set,
+            metrics_label_settings_get, metrics_label_settings_schema, metrics_label_reboot, metrics_label_factory_reset,
+            metrics_label_upload_page, metrics_label_upload
+        };
+
+        // Latency histogram bucket bounds, in microseconds, and their labels; the last bucket is unbounded.
+        const uint32_t metrics_latency_bounds[] PROGMEM = { 5000, 10000, 25000, 50000, 100000, 250000, 500000, 1000000, 2500000 };
+        const char metrics_latency_labels[][6] PROGMEM = { "0.005", "0.01", "0.025", "0.05", "0.1", "0.25", "0.5", "1", "2.5", "+Inf" };
+        const char metrics_status_labels[][4] PROGMEM = { "2xx", "3xx", "4xx", "5xx" };
+
+        //!< The metric families, in output order.
+        enum class MetricFamily {
+            REQUESTS,           //!< Requests, by endpoint.
+            RESPONSES,          //!< Responses, by endpoint and status class.
+            RESPONSE_BYTES,     //!< Response body bytes, by endpoint.
+            RESPONSE_CHUNKS,    //!< Chunks of chunked responses, by endpoint.
+            DURATION,           //!< Latency histogram, by endpoint.
+            AUTH_CHALLENGES,    //!< Authentication challenges sent.
+            UPLOAD_BYTES,       //!< Firmware bytes uploaded.
+            UPLOAD_DURATION,    //!< Time spent receiving firmware.
+            SLOTS_EXHAUSTED,    //!< Requests refused for lack of a response slot.
+            COUNT               //!< The number of families.
+        };
+
+        // Metric family names, help text and types, in `MetricFamily` order.
+        const char metrics_name_requests[] PROGMEM = "web_settings_requests_total";
+        const char metrics_name_responses[] PROGMEM = "web_settings_responses_total";
+        const char metrics_name_response_bytes[] PROGMEM = "web_settings_response_bytes_total";
+        const char metrics_name_response_chunks[] PROGMEM = "web_settings_response_chunks_total";
+        const char metrics_name_duration[] PROGMEM = "web_settings_request_duration_seconds";
+        const char metrics_name_auth_challenges[] PROGMEM = "web_settings_auth_challenges_total";
+        const char metrics_name_upload_bytes[] PROGMEM = "web_settings_upload_bytes_total";
+        const char metrics_name_upload_duration[] PROGMEM = "web_settings_upload_duration_seconds_total";
+        const char metrics_name_slots_exhausted[] PROGMEM = "web_settings_response_slots_exhausted_total";
+        PGM_P const metrics_names[] PROGMEM = {
+            metrics_name_requests, metrics_name_responses, metrics_name_response_bytes, metrics_name_response_chunks,
+            metrics_name_duration, metrics_name_auth_challenges, metrics_name_upload_bytes, metrics_name_upload_duration,
+            metrics_name_slots_exhausted
+        };
+        const char metrics_help_requests[] PROGMEM = " Requests received.\n";
+        const char metrics_help_responses[] PROGMEM = " Responses sent, by status class.\n";
+        const char metrics_help_response_bytes[] PROGMEM = " Response body bytes generated.\n";
+        const char metrics_help_response_chunks[] PROGMEM = " Chunks generated for chunked responses.\n";
+        const char metrics_help_duration[] PROGMEM = " Time from receiving a request until its response is complete.\n";
+        const char metrics_help_auth_challenges[] PROGMEM = " Authentication challenges sent.\n";
+        const char metrics_help_upload_bytes[] PROGMEM = " Firmware bytes uploaded.\n";
+        const char metrics_help_upload_duration[] PROGMEM = " Time spent receiving firmware uploads.\n";
+        const char metrics_help_slots_exhausted[] PROGMEM = " Requests refused because all response slots were in use.\n";
+        PGM_P const metrics_help[] PROGMEM = {
+            metrics_help_requests, metrics_help_responses, metrics_help_response_bytes, metrics_help_response_chunks,
+            metrics_help_duration, metrics_help_auth_challenges, metrics_help_upload_bytes, metrics_help_upload_duration,
+            metrics_help_slots_exhausted
+        };
+        const char metrics_type_counter[] PROGMEM = " counter\n";
+        const char metrics_type_histogram[] PROGMEM = " histogram\n";
+
+        //!< Read a pointer from a PROGMEM table.
+        PGM_P read_pgm_pointer(PGM_P const *table, size_t index)
+        {
+            return reinterpret_cast<PGM_P>(pgm_read_ptr(&table[index]));
+        }
+
+        //!< Write a time in seconds, given in microseconds.
+        void write_seconds(HtmlWriter &writer, uint64_t microseconds)
+        {
+            writer.write_unsigned(static_cast<uint32_t>(microseconds / 1000000));
+            uint32_t fraction = static_cast<uint32_t>(microseconds % 1000000);
+            char digits[7] = "000000";
+            for (int i = 5; i >= 0; --i, fraction /= 10)
+            {
+                digits[i] = static_cast<char>('0' + fraction % 10);
+            }
+            writer.write('.');
+            writer.write(digits, 6);
+        }
+
+        constexpr uint32_t style_css_hash = name_hash::hash(assets::style_css_gz, sizeof(assets::style_css_gz));
+        constexpr uint32_t script_js_hash = name_hash::hash(assets::script_js_gz, sizeof(assets::script_js_gz));
+        static_assert(style_css_hash == assets::style_css_gz_hash, "WebAssets.h has been modified; regenerate it with tools/build_assets.py");
+        static_assert(script_js_hash == assets::script_js_gz_hash, "WebAssets.h has been modified; regenerate it with tools/build_assets.py");
+        constexpr EntityTag style_css_etag = make_entity_tag(style_css_hash);
+        constexpr EntityTag script_js_etag = make_entity_tag(script_js_hash);
+
+        constexpr size_t upload_buffer_size = 4096;     //!< The size of a firmware upload buffer; one flash sector.
+
+        /**
+         * @brief Convert hexadecimal text to binary.
+         *
+         * @param text      The text.
+         * @param data      Receives the binary data.
+         * @param length    The length of the binary data.
+         * @return `false` if the text is not `length` bytes in hexadecimal.
+         */
+        bool parse_hex(const String &text, uint8_t *data, size_t length)
         {
+            if (text.length() != length * 2)
+            {
+                return false;
+            }
+            for (size_t i = 0; i < length * 2; ++i)
+            {
+                char ch = text[i];
+                uint8_t nibble;
+                if (ch >= '0' && ch <= '9')
+                {
+                    nibble = ch - '0';
+                }
+                else if (ch >= 'a' && ch <= 'f')
+                {
+                    nibble = ch - 'a' + 10;
+                }
+                else if (ch >= 'A' && ch <= 'F')
+                {
+                    nibble = ch - 'A' + 10;
+                }
+                else
+                {
+                    return false;
+                }
+                data[i / 2] = (i % 2 == 0) ? nibble << 4 : data[i / 2] | nibble;
+            }
             return true;
         }
 
-        size_t can_send = std::min(maxLen - size, remaining);
-        memcpy_P(&buffer[size], &string_buffer[sent_static_size], can_send);
-        size += can_send;
-        sent_static_size += can_send;
-        return can_send == remaining;
+        // The estimated heap used by the server for a response, besides its send buffer: the
+        // request and response objects, and headers.
+        constexpr size_t response_heap_cost = 1024;
+
+        // The largest send buffer the server allocates for a response: the TCP send buffer, with
+        // lwIP's default MSS. A response is sent in pieces no larger than this.
+        constexpr size_t response_send_buffer = 2 * 536;
+
+        // Rough response sizes, for `response_size_estimate`: the fixed part, and the part for
+        // each tab or setting. These are typical sizes, measured with the native benchmark.
+        constexpr size_t main_page_base_size = 1400;
+        constexpr size_t main_page_tab_size = 110;
+        constexpr size_t main_page_setting_size = 100;
+        constexpr size_t schema_base_size = 16;
+        constexpr size_t schema_setting_size = 48;
+        constexpr size_t values_base_size = 16;
+        constexpr size_t values_tab_size = 16;
+        constexpr size_t values_setting_size = 40;
+
+        /**
+         * @brief Append a fragment written through an `HtmlWriter` to a string.
+         *
+         * The fragment is written in pieces through a small buffer, resuming as necessary.
+         *
+         * @param output    The string to append to.
+         * @param write     Writes the fragment; called once per piece.
+         */
+        template<typename F>
+        void append_fragment(String &output, const F &write)
+        {
+            uint8_t buffer[64];
+            size_t offset = 0;
+            for (;;)
+            {
+                HtmlWriter writer(buffer, sizeof(buffer), offset);
+                write(writer);
+                output.concat(reinterpret_cast<const char *>(buffer), writer.size());
+                if (!writer.overflowed())
+                {
+                    break;
+                }
+                offset += writer.size();
+            }
+        }
+
+        /**
+         * @brief Send a pre-compressed asset.
+         *
+         * If the browser already has this version, a 304 response is sent. Requests
+         * carrying the current version as the `v` parameter, as the main page does, can be
+         * cached indefinitely; others must be revalidated.
+         *
+         * @param request       The request.
+         * @param content_type  The asset MIME type.
+         * @param data          The gzip-compressed asset, in PROGMEM.
+         * @param length        The length of `data`.
+         * @param etag          The asset's entity tag.
+         * @return The response status code.
+         */
+        int send_asset(AsyncWebServerRequest *request, const __FlashStringHelper *content_type, const uint8_t *data, size_t length, const EntityTag &etag)
+        {
+            AsyncWebServerResponse *response;
+            int code;
+            if (request->hasHeader(F("If-None-Match")) && strstr(request->header(F("If-None-Match")).c_str(), etag.text) != nullptr)
+            {
+                code = 304;
+                response = request->beginResponse(code);
+            }
+            else
+            {
+                code = 200;
+                response = request->beginResponse_P(code, content_type, data, length);
+                response->addHeader(F("Content-Encoding"), F("gzip"));
+            }
+            response->addHeader(F("ETag"), etag.text);
+
+            const String &version = request->arg(F("v"));
+            if (version.length() == 8 && strncmp(version.c_str(), etag.version(), 8) == 0)
+            {
+                response->addHeader(F("Cache-Control"), F("public, max-age=31536000, immutable"));
+            }
+            else
+            {
+                response->addHeader(F("Cache-Control"), F("no-cache"));
+            }
+            request->send(response);
+            return code;
+        }
     }
 
-    WebSettings::WebSettings(uint16_t port): server(port)
+    WebSettings::WebSettings(uint16_t port): on_save_changes(nullptr), server(port), events(F("/settings/events")), field_setting_count(0), is_setup(false), page_cache_state(PageCacheState::DISABLED), page_cache_size(0), schema_etag(),
+        event_interval(5000), last_event_sample(0), events_resend(true), event_version(0), event_client_limit(2), journal_fs(nullptr), journal_delay(0),
+        journal_compact_size(0), journal_version(0), journal_change_time(0), journal_pending(false), journal_compact(true),
+        restart_snapshot(false), heap_debug(false), main_page_heap(), values_heap(), post_heap(), response_limit(3),
+        response_slots(new ResponseSlot[3]), response_heap_reserve(4096), response_slots_exhausted(0), upload_buffer_count(2)
     {
         generate_new_authentication();
     }
@@ -372,86 +405,109 @@ namespace grmcdorman
         on_save = on_save_f;
         on_restart = on_restart_f;
         on_factory_reset = on_factory_reset_f;
+        is_setup = true;
+        // The footer depends on the callbacks.
+        invalidate_page_cache();
 
-        // Send the chunked main page.
+        // Send the main page; from the page cache if possible, otherwise chunked.
         server.on("/", HTTP_GET, [this] (AsyncWebServerRequest *request)
         {
-            // This allocation will be deleted when the chunked-write completes.
-            MainPageChunkContext *context = new MainPageChunkContext;
-            // WARNING: Do not pass local variables by reference to the lambda; this will not work properly
-            // on anything but the first call.
-            AsyncWebServerResponse *response = request->beginChunkedResponse(TEXT_HTML, [this, context] (uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
-                return on_main_page_chunk(buffer, maxLen, index, context);
-            });
-            request->send(response);
-        });
-
-        // Note that these two are embedded in the main page; however, doing
-        // them also as separate URLs allows other pages to reference them.
-        // The embedding is to maximize efficiency, in both memory usage and processing.
-        server.on("/style.css", HTTP_GET, [this] (AsyncWebServerRequest *request)
-        {
-            // The server does not seem to be very happy sending massive chunks in one go.
-            // This allocation will be deleted when the chunked-write completes.
-            MainPageChunkContext *context = new MainPageChunkContext;
-            // WARNING: Do not pass local variables by reference to the lambda; this will not work properly
-            // on anything but the first call.
-            AsyncWebServerResponse *response = request->beginChunkedResponse(TEXT_HTML, [this, context] (uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
-                if (index == 0)
+            uint32_t start = metrics_request(MetricsEndpoint::MAIN_PAGE);
+            // A page from the cache needs no response slot; the server sends the file.
+            if (page_cache_state == PageCacheState::VALID)
+            {
+                if (!admit_response(request, MetricsEndpoint::MAIN_PAGE, start, response_size_estimate(MetricsEndpoint::MAIN_PAGE), false))
                 {
-                    context->sent_static_size = 0;
+                    return;
                 }
-                size_t size = 0;
-                send_static_string(buffer, maxLen, size, style, context->sent_static_size);
-                if (size == 0)
+                heap_request_start(main_page_heap);
+                if (send_page_cache(request, start))
                 {
-                    delete context;
+                    heap_request_end(main_page_heap);
+                    return;
                 }
-                return size;
-            });
-            request->send(response);
-        });
+            }
 
-        server.on("/script.js", HTTP_GET, [this] (AsyncWebServerRequest *request)
-        {
-            // The server does not seem to be very happy sending massive chunks in one go.
-            // This allocation will be deleted when the chunked-write completes.
-            MainPageChunkContext *context = new MainPageChunkContext;
+            if (!admit_response(request, MetricsEndpoint::MAIN_PAGE, start, response_size_estimate(MetricsEndpoint::MAIN_PAGE), true))
+            {
+                return;
+            }
+            heap_request_start(main_page_heap);
+
+            // The context is in the request's response slot; it is released when the chunked-write
+            // completes, or when the client disconnects.
+            MainPageChunkContext *context = create_context<MainPageChunkContext>(request);
             // WARNING: Do not pass local variables by reference to the lambda; this will not work properly
             // on anything but the first call.
-            AsyncWebServerResponse *response = request->beginChunkedResponse(TEXT_HTML, [this, context] (uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
-                if (index == 0)
-                {
-                    context->sent_static_size = 0;
-                }
-                size_t size = 0;
-                send_static_string(buffer, maxLen, size, javascript_text, context->sent_static_size);
+            AsyncWebServerResponse *response = request->beginChunkedResponse(TEXT_HTML, [this, request, context, start] (uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+                heap_request_sample(main_page_heap);
+                size_t size = on_main_page_chunk(buffer, maxLen, index, context);
+                metrics_chunk(MetricsEndpoint::MAIN_PAGE, size);
                 if (size == 0)
                 {
-                    delete context;
+                    release_response(request);
+                    heap_request_end(main_page_heap);
+                    metrics_response(MetricsEndpoint::MAIN_PAGE, start, 200, 0);
                 }
                 return size;
             });
             request->send(response);
         });
 
+        // The style sheet and script are referenced by the main page, and by
+        // other pages. They are stored pre-compressed; see tools/build_assets.py.
+        server.on("/style.css", HTTP_GET, [this] (AsyncWebServerRequest *request)
+        {
+            uint32_t start = metrics_request(MetricsEndpoint::STYLE_CSS);
+            if (!admit_response(request, MetricsEndpoint::STYLE_CSS, start, response_size_estimate(MetricsEndpoint::STYLE_CSS), false))
+            {
+                return;
+            }
+            int code = send_asset(request, TEXT_CSS, assets::style_css_gz, assets::style_css_gz_length, style_css_etag);
+            metrics_response(MetricsEndpoint::STYLE_CSS, start, code, code == 200 ? assets::style_css_gz_length : 0);
+        });
+
+        server.on("/script.js", HTTP_GET, [this] (AsyncWebServerRequest *request)
+        {
+            uint32_t start = metrics_request(MetricsEndpoint::SCRIPT_JS);
+            if (!admit_response(request, MetricsEndpoint::SCRIPT_JS, start, response_size_estimate(MetricsEndpoint::SCRIPT_JS), false))
+            {
+                return;
+            }
+            int code = send_asset(request, TEXT_JAVASCRIPT, assets::script_js_gz, assets::script_js_gz_length, script_js_etag);
+            metrics_response(MetricsEndpoint::SCRIPT_JS, start, code, code == 200 ? assets::script_js_gz_length : 0);
+        });
+
         server.on("/settings/set", HTTP_POST, [this](AsyncWebServerRequest *request)
         {
+            uint32_t start = metrics_request(MetricsEndpoint::SETTINGS_SET);
             if (!verify_authentication(request))
             {
+                metrics_response(MetricsEndpoint::SETTINGS_SET, start, 401, 0);
                 return;
             }
-            for (auto &setting : setting_panels)
+            heap_request_start(post_heap);
+            // Settings changed by the POST have a later version.
+            uint32_t start_version = SettingInterface::get_current_version();
+            on_post_settings(request);
+            heap_request_sample(post_heap);
+            if (SettingInterface::get_current_version() != start_version)
             {
-                // Settings have unique IDs accross all tabs.
-                setting->on_post(request);
+                schedule_settings_save();
             }
             if (on_save != nullptr)
             {
                 on_save(*this);
             }
+            if (on_save_changes != nullptr)
+            {
+                on_save_changes(*this, get_changes_since(start_version));
+            }
             // Response is JSON.
-            request->send(200, TEXT_JSON, F("{\"saved\":true}"));
+            static const char saved[] PROGMEM = "{\"saved\":true}";
+            request->send(200, TEXT_JSON, FPSTR(saved));
+            heap_request_end(post_heap);
+            metrics_response(MetricsEndpoint::SETTINGS_SET, start, 200, sizeof(saved) - 1);
         });
 
         server.on("/settings/get", HTTP_GET, [this](AsyncWebServerRequest *request)
@@ -459,16 +515,59 @@ namespace grmcdorman
             on_request_values(request);
         });
 
+        // A newly connected browser needs all values.
+        events.onConnect([this] (AsyncEventSourceClient *)
+        {
+            events_resend = true;
+        });
+        // Connections are long lived, so they take no response slot, but are limited in number;
+        // a browser that is refused falls back to polling.
+        events.setFilter([this] (AsyncWebServerRequest *)
+        {
+            return events.count() < event_client_limit &&
+                ESP.getMaxFreeBlockSize() >= response_heap_cost + response_heap_reserve;
+        });
+        server.addHandler(&events);
+
+        server.on("/settings/schema", HTTP_GET, [this](AsyncWebServerRequest *request)
+        {
+            on_request_schema(request);
+        });
+
+        if (metrics)
+        {
+            server.on("/metrics", HTTP_GET, [this](AsyncWebServerRequest *request)
+            {
+                on_request_metrics(request);
+            });
+        }
+
+        if (heap_debug)
+        {
+            server.on("/debug/heap", HTTP_GET, [this](AsyncWebServerRequest *request)
+            {
+                on_request_heap(request);
+            });
+        }
+
         if (on_restart != nullptr)
         {
             server.on("/reboot", HTTP_GET, [this] (AsyncWebServerRequest *request)
             {
+                uint32_t start = metrics_request(MetricsEndpoint::REBOOT);
                 if (!verify_authentication(request))
                 {
+                    metrics_response(MetricsEndpoint::REBOOT, start, 401, 0);
                     return;
                 }
-                request->send(200, TEXT_HTML, F("Device is rebooting. <a href=\"/\">Back to root (wait for reboot!)</a>"));
+                static const char rebooting[] PROGMEM = "Device is rebooting. <a href=\"/\">Back to root (wait for reboot!)</a>";
+                request->send(200, TEXT_HTML, FPSTR(rebooting));
+                metrics_response(MetricsEndpoint::REBOOT, start, 200, sizeof(rebooting) - 1);
                 delay(2000);
+                if (restart_snapshot)
+                {
+                    save_restart_snapshot();
+                }
                 on_restart(*this);
             });
         }
@@ -477,19 +576,25 @@ namespace grmcdorman
         {
             server.on("/factoryreset", HTTP_GET, [this] (AsyncWebServerRequest *request)
             {
+                uint32_t start = metrics_request(MetricsEndpoint::FACTORY_RESET);
                 if (!verify_authentication(request))
                 {
+                    metrics_response(MetricsEndpoint::FACTORY_RESET, start, 401, 0);
                     return;
                 }
                 if (request->hasArg("confirm") && request->arg("confirm") == "true")
                 {
-                    request->send(200, TEXT_HTML, F("Device is resetting. You will need to reconnect to the soft AP to configure afterwards."));
+                    static const char resetting[] PROGMEM = "Device is resetting. You will need to reconnect to the soft AP to configure afterwards.";
+                    request->send(200, TEXT_HTML, FPSTR(resetting));
+                    metrics_response(MetricsEndpoint::FACTORY_RESET, start, 200, sizeof(resetting) - 1);
                     delay(1000);
                     on_factory_reset(*this);
                 }
                 else
                 {
-                    request->send(200, TEXT_HTML, F("Reset to factory defaults not confirmed. <a href=\"/\">Back to root</a>"));
+                    static const char not_confirmed[] PROGMEM = "Reset to factory defaults not confirmed. <a href=\"/\">Back to root</a>";
+                    request->send(200, TEXT_HTML, FPSTR(not_confirmed));
+                    metrics_response(MetricsEndpoint::FACTORY_RESET, start, 200, sizeof(not_confirmed) - 1);
                 }
             });
         }
@@ -498,13 +603,16 @@ namespace grmcdorman
         {
             server.on("/upload", HTTP_GET, [this] (AsyncWebServerRequest *request)
             {
+                uint32_t start = metrics_request(MetricsEndpoint::UPLOAD_PAGE);
                 if (!verify_authentication(request))
                 {
+                    metrics_response(MetricsEndpoint::UPLOAD_PAGE, start, 401, 0);
                     return;
                 }
-                on_request_upload(request);
+                metrics_response(MetricsEndpoint::UPLOAD_PAGE, start, 200, on_request_upload(request));
             });
 
+            // The response to an upload is sent by `handle_upload`.
             server.on("/upload", HTTP_POST, [this] (AsyncWebServerRequest *request)
             {
                 if (!verify_authentication(request))
@@ -516,6 +624,10 @@ namespace grmcdorman
             {
                 if (!verify_authentication(request))
                 {
+                    if (index == 0)
+                    {
+                        metrics_response(MetricsEndpoint::UPLOAD, metrics_request(MetricsEndpoint::UPLOAD), 401, 0);
+                    }
                     return;
                 }
                 handle_upload(request, filename, index, data, len, final);
@@ -527,30 +639,6 @@ namespace grmcdorman
         server.begin();
     }
 
-    /**
-     * @brief This templated function ensures a safe copy to the buffer.
-     *
-     * It will copy PROGMEM data from a source string to the target. Trailing
-     * NULL is omitted. If the size exceeds the remaining available, nothing is done.
-     *
-     * @tparam N        Template parameter; automatically deduced from array size.
-     * @param buffer    Output buffer.
-     * @param string    The string to copy to the output buffer.
-     * @param size      Current used size in the output buffer.
-     * @param maxLen    Maximum buffer size.
-     */
-    template<size_t N>
-    void buffer_append(uint8_t *buffer, const char (&string)[N], size_t &size, size_t maxLen)
-    {
-        if (size + N > maxLen)
-        {
-            // Would overflow.
-            return;
-        }
-        memcpy_P(&buffer[size], string, N - 1);
-        size += N - 1;
-    }
-
     bool WebSettings::on_main_page_tabbutton_chunk(uint8_t *buffer, size_t maxLen, size_t &size, MainPageChunkContext &context)
     {
         static const char button_start[] PROGMEM = "<button class=\"tablinks";
@@ -558,47 +646,31 @@ namespace grmcdorman
         static const char onclick[] PROGMEM = "\" onclick=\"openTab(event, '";
         static const char onclick_end[] PROGMEM = "')\">";
         static const char button_end[] PROGMEM = "</button>";
-        // Length of one button, without the two instances of the setting name.
-        static constexpr size_t basic_length =
-            sizeof(button_start) - 1 +
-            sizeof(onclick) - 1 +
-            sizeof(onclick_end) - 1 +
-            sizeof(button_end) - 1;
-
-        // Stuff as much as possible in the oiutput without overflowing.
-        while (context.current_panel != setting_panels.end())
-        {
-            bool first = context.current_panel == setting_panels.begin();
-            auto &panel = **context.current_panel;
-            size_t name_length = panel.get_name_length();
-            auto name = panel.get_name();
-            size_t identifier_length = panel.get_identifier_length();
-            auto identifier = panel.get_identifier();
-
-            // Compute the expected text length.
-            size_t len = basic_length + (first ? sizeof(active) -1 : 0) +
-                name_length + identifier_length;
-
-            if (len + size > maxLen)
-            {
-                // Does not fit.
-                return false;
-            }
 
-            buffer_append(buffer, button_start, size, maxLen);
-            if (first)
+        // Each button is written with a resumable writer; a button that does not
+        // fit is continued in the next chunk.
+        while (context.current_panel < setting_panels.size())
+        {
+            const auto &panel = setting_panels[context.current_panel];
+            HtmlWriter writer(&buffer[size], maxLen - size, context.fragment_offset);
+            writer.write_P(button_start);
+            if (context.current_panel == 0)
             {
-                buffer_append(buffer, active, size, maxLen);
-                first =- false;
+                writer.write_P(active);
             }
-            buffer_append(buffer, onclick, size, maxLen);
-            memcpy_P(&buffer[size], identifier, identifier_length);
-            size += identifier_length;
-            buffer_append(buffer, onclick_end, size, maxLen);
-            memcpy_P(&buffer[size], name, name_length);
-            size += name_length;
-            buffer_append(buffer, button_end, size, maxLen);
-
+            writer.write_P(onclick);
+            writer.write(panel.get_identifier());
+            writer.write_P(onclick_end);
+            writer.write(panel.get_name());
+            writer.write_P(button_end);
+
+            size += writer.size();
+            if (writer.overflowed())
+            {
+                context.fragment_offset += writer.size();
+                return false;
+            }
+            context.fragment_offset = 0;
             ++context.current_panel;
         }
 
@@ -607,93 +679,81 @@ namespace grmcdorman
 
     bool WebSettings::on_main_page_tabbody_chunk(uint8_t *buffer, size_t maxLen, size_t &size, MainPageChunkContext &context)
     {
-        while (context.current_panel != setting_panels.end())
-        {
-            static const char tab_start[] PROGMEM = "<div id=\"";
-            static const char tab_class[] PROGMEM = "\" class=\"tabcontent";
-            static const char active[] PROGMEM = " active";
-            static const char end_start[] PROGMEM = "\">";
-            static const char end_tab[] PROGMEM = "<div style=\"clear: both\"></div></div>";
-            static const char first_tabbutton_begin[] PROGMEM =
-                "</div>"
-                "<form method=\"post\" id=\"settings_form\" action=\"/savesettings\">";
-
-            bool first = context.current_panel == setting_panels.begin();
-            const auto &panel = **context.current_panel;
-            size_t identifier_length = panel.get_identifier_length();
-            auto identifier = panel.get_identifier();
-
-            // Were the preliminaries written?
+        static const char tab_start[] PROGMEM = "<div id=\"";
+        static const char tab_class[] PROGMEM = "\" class=\"tabcontent";
+        static const char active[] PROGMEM = " active";
+        static const char lazy[] PROGMEM = "\" data-lazy=\"true";
+        static const char end_start[] PROGMEM = "\">";
+        static const char end_tab[] PROGMEM = "</div>";
+        static const char first_tabbutton_begin[] PROGMEM =
+            "</div>"
+            "<form method=\"post\" id=\"settings_form\" action=\"/savesettings\">";
+
+        while (context.current_panel < setting_panels.size())
+        {
+            bool first = context.current_panel == 0;
+            const auto &panel = setting_panels[context.current_panel];
+
+            // The start of the tab, the panel body and the end of the tab are each
+            // written with a resumable writer, and continued in the next chunk if
+            // they do not fit.
             if (context.starting_tab)
             {
-                // Yes. Will the preliminaries fit?
-                size_t preliminary_len =
-                    sizeof(tab_start) - 1 +
-                    identifier_length +
-                    sizeof (tab_class) - 1 +
-                    (first ? sizeof(first_tabbutton_begin) -1  + sizeof(active) - 1 : 0) +
-                    sizeof (end_start) - 1;
-
-                if (preliminary_len + size > maxLen)
+                HtmlWriter writer(&buffer[size], maxLen - size, context.fragment_offset);
+                if (first)
                 {
-                    // No. Continue in next chunk.
-                    return false;
+                    writer.write_P(first_tabbutton_begin);
                 }
-
-                // Preliminaries fit.
+                writer.write_P(tab_start);
+                writer.write(panel.get_identifier());
+                writer.write_P(tab_class);
                 if (first)
                 {
-                    buffer_append(buffer, first_tabbutton_begin, size, maxLen);
+                    writer.write_P(active);
                 }
+                else
+                {
+                    writer.write_P(lazy);
+                }
+                writer.write_P(end_start);
 
-                buffer_append(buffer, tab_start, size, maxLen);
-
-                memcpy_P(&buffer[size], identifier, identifier_length);
-                size += identifier_length;
-
-                buffer_append(buffer, tab_class, size, maxLen);
-                if (first)
+                size += writer.size();
+                if (writer.overflowed())
                 {
-                    buffer_append(buffer, active, size, maxLen);
+                    context.fragment_offset += writer.size();
+                    return false;
                 }
-                buffer_append(buffer, end_start, size, maxLen);
+                context.fragment_offset = 0;
 
                 context.starting_tab = false;
-                context.current_setting = panel.get_settings().begin();
-            }
-
-            // Now, try to stuff in settings until done or out of room.
-            String panel_identifier(panel.get_identifier());
-            String html;
-            while (context.current_setting != panel.get_settings().end())
-            {
-                const auto &setting = *context.current_setting;
-                html = setting->get_html(panel_identifier);
-                if (html.length() + size > maxLen)
+                context.panel_body = PanelBodyChunkContext();
+                if (!first)
                 {
-                    // Can't fit this settting.
-                    return false;
+                    // Only the first panel is sent with the page; the others
+                    // are an empty placeholder, filled in when first opened.
+                    context.panel_body.state = PanelBodyChunkState::DONE;
                 }
-                memcpy(&buffer[size], html.c_str(), html.length());
-                size += html.length();
+            }
 
-                ++context.current_setting;
+            if (!on_panel_body_chunk(buffer, maxLen, size, panel, context.panel_body))
+            {
+                return false;
             }
 
-            // All settings have been included. Will the tab footer fit?
-            if (sizeof (end_tab) + size - 1 > maxLen)
+            // All settings have been included. When resumed, `starting_tab` is false
+            // and the panel body is done, so this comes straight back to the tab end.
+            HtmlWriter writer(&buffer[size], maxLen - size, context.fragment_offset);
+            writer.write_P(end_tab);
+            size += writer.size();
+            if (writer.overflowed())
             {
-                // Won't fit. Will come back in, `starting_tab` will be false,
-                // and the current_setting will equal `end()`, so it'll come
-                // straight to trying to do the tab footer again.
+                context.fragment_offset += writer.size();
                 return false;
             }
+            context.fragment_offset = 0;
 
-            buffer_append(buffer, end_tab, size, maxLen);
             // Can move to the next panel.
             ++context.current_panel;
-            context.current_setting = context.current_panel != setting_panels.end() ? setting_panels.front()->get_settings().begin() :
-                SettingInterface::settings_list_t::const_iterator();
             context.starting_tab = true;
         }
 
@@ -701,360 +761,1950 @@ namespace grmcdorman
         return true;
     }
 
-    bool WebSettings::on_main_page_footer_chunk(uint8_t *buffer, size_t maxLen, size_t &size, MainPageChunkContext &context)
+    bool WebSettings::on_panel_body_chunk(uint8_t *buffer, size_t maxLen, size_t &size, const SettingPanel &panel, PanelBodyChunkContext &context)
     {
-        static const char footer_start[] PROGMEM =
-                    "<input class=\"md_button ripple\" type=\"submit\" value=\"Save\">"
-                    "<a class=\"md_button ripple\" onclick=\"reloadAllTabs()\">Reset Form</a>";
-        static const char hr_text[] PROGMEM = "<hr>";
-        static const char reboot_button[] PROGMEM =
-            "<a class=\"md_button ripple red\" href=\"/reboot\">Reboot</a>";
-        static const char factory_reset_button[] PROGMEM =
-            "<a class=\"md_button ripple red\" onclick=\"factoryReset()\">Factory Defaults</a>";
-        static const char upload_button[] PROGMEM =
-            "<a class=\"md_button ripple red\" href=\"/upload\">Upload Firmware</a>";
-        static const char footer_end[] PROGMEM =
-                "</form>"
-                "<script>"
-                    "var form = document.getElementById(\"settings_form\");"
-                    "form.addEventListener(\"submit\", function ( event ) {"
-                        "event.preventDefault();"
-                        "sendData(\"settings\");"
-                    "})"
-                "</script>"
-            "</body>"
-            "</html>";
-        size_t len =
-            sizeof(footer_start) - 1 +
-            sizeof(footer_end);
-
-        if (on_restart != nullptr)
-        {
-            len +=
-                sizeof (hr_text) - 1 +
-                sizeof (reboot_button) -1 +
-                (on_factory_reset != nullptr ? sizeof (factory_reset_button) - 1 : 0) +
-                sizeof (hr_text) +
-                sizeof (upload_button) - 1;
-        }
-        else if (on_factory_reset != nullptr)
+        // The marker tells the POST handler that the panel's fields are present in the form.
+        static const char marker_start[] PROGMEM = "<input type=\"hidden\" name=\"";
+        static const char marker_end[] PROGMEM = "$\" value=\"1\">";
+        static const char body_end[] PROGMEM = "<div style=\"clear: both\"></div>";
+
+        const auto &settings = panel.get_settings();
+        // Each piece is written with a resumable writer; a piece that does not
+        // fit is continued in the next chunk.
+        while (context.state != PanelBodyChunkState::DONE)
         {
-            len +=
-                sizeof (hr_text) - 1 +
-                sizeof (factory_reset_button) - 1;
-        }
+            HtmlWriter writer(&buffer[size], maxLen - size, context.fragment_offset);
+            switch (context.state)
+            {
+                case PanelBodyChunkState::MARKER:
+                    writer.write_P(marker_start);
+                    writer.write(panel.get_identifier());
+                    writer.write_P(marker_end);
+                    break;
 
-        if (len + size > maxLen)
-        {
-            return false;
-        }
+                case PanelBodyChunkState::SETTINGS:
+                    (*context.current_setting)->write_html(writer, panel.get_identifier());
+                    break;
 
-        buffer_append(buffer, footer_start, size, maxLen);
-        if (on_restart != nullptr)
-        {
-            buffer_append(buffer, hr_text, size, maxLen);
-            buffer_append(buffer, reboot_button, size, maxLen);
-            if (factory_reset_button != nullptr)
+                default:
+                    writer.write_P(body_end);
+                    break;
+            }
+
+            size += writer.size();
+            if (writer.overflowed())
             {
-                buffer_append(buffer, factory_reset_button, size, maxLen);
+                context.fragment_offset += writer.size();
+                return false;
+            }
+
+            context.fragment_offset = 0;
+            switch (context.state)
+            {
+                case PanelBodyChunkState::MARKER:
+                    context.current_setting = settings.begin();
+                    context.state = PanelBodyChunkState::SETTINGS;
+                    break;
+
+                case PanelBodyChunkState::SETTINGS:
+                    ++context.current_setting;
+                    break;
+
+                default:
+                    context.state = PanelBodyChunkState::DONE;
+                    break;
             }
-            buffer_append(buffer, hr_text, size, maxLen);
-            buffer_append(buffer, upload_button, size, maxLen);
-        }
-        else if (on_factory_reset != nullptr)
-        {
-            buffer_append(buffer, hr_text, size, maxLen);
-            buffer_append(buffer, factory_reset_button, size, maxLen);
-        }
 
-        buffer_append(buffer, footer_end, size, maxLen);
+            if (context.state == PanelBodyChunkState::SETTINGS && context.current_setting == settings.end())
+            {
+                context.state = PanelBodyChunkState::END;
+            }
+        }
 
         return true;
     }
 
-    size_t WebSettings::on_main_page_chunk(uint8_t *buffer, size_t maxLen, size_t index, MainPageChunkContext *context_ptr)
+    size_t WebSettings::on_schema_chunk(uint8_t *buffer, size_t maxLen, SchemaChunkContext &context)
     {
-        auto & context = *context_ptr;
-        size_t size(0);
-        if (index == 0)
+        static const char panel_start[] PROGMEM = "{\"i\":\"";
+        static const char panel_name[] PROGMEM = "\",\"n\":\"";
+        static const char panel_settings[] PROGMEM = "\",\"s\":[";
+        size_t size = 0;
+        // Each piece is written with a resumable writer; a piece that does not
+        // fit is continued in the next chunk.
+        while (context.state != SchemaChunkState::DONE)
         {
-            context.sent_static_size = 0;
-        }
+            HtmlWriter writer(&buffer[size], maxLen - size, context.fragment_offset);
+            switch (context.state)
+            {
+                case SchemaChunkState::BEGIN:
+                    writer.write('[');
+                    break;
 
-        switch (context.state)
-        {
-            case MainPageChunkState::BEGIN_PAGE:
-                // This assumes that the page begin fits in the buffer. That's a pretty
-                // safe assumption, this string is rather short.
-                static const char main_page_begin_page[] PROGMEM =
-                    "<!DOCTYPE html>"
-                    "<meta http-equiv=\"X-UA-Compatible\" content=\"IE=edge,chrome=1\">"
-                    "<html>"
-                        "<style>";
-                send_static_string(buffer, maxLen, size, main_page_begin_page, context.sent_static_size);
-                context.state = MainPageChunkState::STYLE_SHEET;
-                context.sent_static_size = 0;
-                // FALL THROUGH
-            case MainPageChunkState::STYLE_SHEET:
-                // The entire style sheet doesn't typically fit in one buffer.
-                if (!send_static_string(buffer, maxLen, size, style, context.sent_static_size))
-                {
+                case SchemaChunkState::PANEL_START:
+                    if (context.current_panel != 0)
+                    {
+                        writer.write(',');
+                    }
+                    writer.write_P(panel_start);
+                    writer.write_json_escaped(setting_panels[context.current_panel].get_identifier());
+                    writer.write_P(panel_name);
+                    writer.write_json_escaped(setting_panels[context.current_panel].get_name());
+                    writer.write_P(panel_settings);
                     break;
+
+                case SchemaChunkState::SETTINGS:
+                    if (context.current_setting != setting_panels[context.current_panel].get_settings().begin())
+                    {
+                        writer.write(',');
+                    }
+                    (*context.current_setting)->write_schema(writer);
+                    break;
+
+                case SchemaChunkState::PANEL_END:
+                    writer.write(F("]}"));
+                    break;
+
+                default:
+                    writer.write(']');
+                    break;
+            }
+
+            size += writer.size();
+            if (writer.overflowed())
+            {
+                context.fragment_offset += writer.size();
+                break;
+            }
+
+            context.fragment_offset = 0;
+            switch (context.state)
+            {
+                case SchemaChunkState::BEGIN:
+                    context.current_panel = 0;
+                    context.state = SchemaChunkState::PANEL_START;
+                    break;
+
+                case SchemaChunkState::PANEL_START:
+                    context.current_setting = setting_panels[context.current_panel].get_settings().begin();
+                    context.state = SchemaChunkState::SETTINGS;
+                    break;
+
+                case SchemaChunkState::SETTINGS:
+                    ++context.current_setting;
+                    break;
+
+                case SchemaChunkState::PANEL_END:
+                    ++context.current_panel;
+                    context.state = SchemaChunkState::PANEL_START;
+                    break;
+
+                default:
+                    context.state = SchemaChunkState::DONE;
+                    break;
+            }
+
+            if (context.state == SchemaChunkState::SETTINGS && context.current_setting == setting_panels[context.current_panel].get_settings().end())
+            {
+                context.state = SchemaChunkState::PANEL_END;
+            }
+            if (context.state == SchemaChunkState::PANEL_START && context.current_panel == setting_panels.size())
+            {
+                context.state = SchemaChunkState::END;
+            }
+        }
+
+        return size;
+    }
+
+    size_t WebSettings::on_values_chunk(uint8_t *buffer, size_t maxLen, ValuesChunkContext &context)
+    {
+        static const char panel_end[] PROGMEM = "\":[";
+        size_t size = 0;
+        // Each piece is written with a resumable writer; a piece that does not
+        // fit is continued in the next chunk.
+        while (context.state != ValuesChunkState::DONE)
+        {
+            if (context.state == ValuesChunkState::SETTINGS && !context.value_prepared)
+            {
+                // Skip settings that are not sent; prepare the value of the next one that is.
+                // This is only done once per setting, so that the value is the same when resumed.
+                // Values are prepared before checking the version, as that may change the value.
+                const auto &settings = setting_panels[context.panels[context.current_panel]].get_settings();
+                while (context.current_setting != settings.end())
+                {
+                    const auto &setting = **context.current_setting;
+                    if (SettingPanel::is_sent(setting, context.requested_settings))
+                    {
+                        setting.prepare_to_send();
+                        if (!context.has_since || setting.get_version() > context.since)
+                        {
+                            break;
+                        }
+                    }
+                    ++context.current_setting;
                 }
-                context.state = MainPageChunkState::PRE_JAVASCRIPT;
-                context.sent_static_size = 0;
-                // FALL THROUGH
-            case MainPageChunkState::PRE_JAVASCRIPT:
-                static const char transition_style_to_script[] PROGMEM = "</style><script language=\"javascript\">";
-                if (!send_static_string(buffer, maxLen, size, transition_style_to_script, context.sent_static_size))
+                if (context.current_setting == settings.end())
                 {
-                    break;
+                    context.state = ValuesChunkState::PANEL_END;
                 }
-                context.state = MainPageChunkState::JAVASCRIPT;
-                context.sent_static_size = 0;
-                // FALL THROUGH
-            case MainPageChunkState::JAVASCRIPT:
-                if (!send_static_string(buffer, maxLen, size, javascript_text, context.sent_static_size))
+                else
                 {
-                    break;
+                    context.value_prepared = true;
                 }
-                context.state = MainPageChunkState::POST_JAVASCRIPT;
-                context.sent_static_size = 0;
-                // FALL THROUGH
-            case MainPageChunkState::POST_JAVASCRIPT:
-                static const char transition_script_to_body[] PROGMEM =
-                    "</script><body>"
+            }
+
+            HtmlWriter writer(&buffer[size], maxLen - size, context.fragment_offset);
+            switch (context.state)
+            {
+                case ValuesChunkState::BEGIN:
+                    writer.write('{');
+                    break;
+
+                case ValuesChunkState::PANEL_START:
+                    if (context.current_panel != 0)
+                    {
+                        writer.write(',');
+                    }
+                    writer.write('"');
+                    writer.write_json_escaped(setting_panels[context.panels[context.current_panel]].get_identifier());
+                    writer.write_P(panel_end);
+                    break;
+
+                case ValuesChunkState::SETTINGS:
+                    if (!context.first_value)
+                    {
+                        writer.write(',');
+                    }
+                    (*context.current_setting)->write_json(writer);
+                    break;
+
+                case ValuesChunkState::PANEL_END:
+                    writer.write(']');
+                    break;
+
+                default:
+                    writer.write('}');
+                    break;
+            }
+
+            size += writer.size();
+            if (writer.overflowed())
+            {
+                context.fragment_offset += writer.size();
+                break;
+            }
+
+            context.fragment_offset = 0;
+            switch (context.state)
+            {
+                case ValuesChunkState::BEGIN:
+                    context.current_panel = 0;
+                    context.state = ValuesChunkState::PANEL_START;
+                    break;
+
+                case ValuesChunkState::PANEL_START:
+                    context.current_setting = setting_panels[context.panels[context.current_panel]].get_settings().begin();
+                    context.first_value = true;
+                    context.state = ValuesChunkState::SETTINGS;
+                    break;
+
+                case ValuesChunkState::SETTINGS:
+                    context.first_value = false;
+                    context.value_prepared = false;
+                    ++context.current_setting;
+                    break;
+
+                case ValuesChunkState::PANEL_END:
+                    ++context.current_panel;
+                    context.state = ValuesChunkState::PANEL_START;
+                    break;
+
+                default:
+                    context.state = ValuesChunkState::DONE;
+                    break;
+            }
+
+            if (context.state == ValuesChunkState::PANEL_START && context.current_panel == context.panels.size())
+            {
+                context.state = ValuesChunkState::END;
+            }
+        }
+
+        return size;
+    }
+
+    bool WebSettings::on_main_page_footer_chunk(uint8_t *buffer, size_t maxLen, size_t &size, MainPageChunkContext &context)
+    {
+        static const char footer_start[] PROGMEM =
+                    "<input class=\"md_button ripple\" type=\"submit\" value=\"Save\">"
+                    "<a class=\"md_button ripple\" onclick=\"reloadAllTabs()\">Reset Form</a>";
+        static const char hr_text[] PROGMEM = "<hr>";
+        static const char reboot_button[] PROGMEM =
+            "<a class=\"md_button ripple red\" href=\"/reboot\">Reboot</a>";
+        static const char factory_reset_button[] PROGMEM =
+            "<a class=\"md_button ripple red\" onclick=\"factoryReset()\">Factory Defaults</a>";
+        static const char upload_button[] PROGMEM =
+            "<a class=\"md_button ripple red\" href=\"/upload\">Upload Firmware</a>";
+        static const char footer_end[] PROGMEM =
+                "</form>"
+                "<script>"
+                    "var form = document.getElementById(\"settings_form\");"
+                    "form.addEventListener(\"submit\", function ( event ) {"
+                        "event.preventDefault();"
+                        "sendData(\"settings\");"
+                    "})"
+                "</script>"
+            "</body>"
+            "</html>";
+
+        // The footer is written with a resumable writer, so it may span chunks.
+        HtmlWriter writer(&buffer[size], maxLen - size, context.fragment_offset);
+        writer.write_P(footer_start);
+        if (on_restart != nullptr)
+        {
+            writer.write_P(hr_text);
+            writer.write_P(reboot_button);
+            if (on_factory_reset != nullptr)
+            {
+                writer.write_P(factory_reset_button);
+            }
+            writer.write_P(hr_text);
+            writer.write_P(upload_button);
+        }
+        else if (on_factory_reset != nullptr)
+        {
+            writer.write_P(hr_text);
+            writer.write_P(factory_reset_button);
+        }
+        writer.write_P(footer_end);
+
+        size += writer.size();
+        if (writer.overflowed())
+        {
+            context.fragment_offset += writer.size();
+            return false;
+        }
+        context.fragment_offset = 0;
+        return true;
+    }
+
+    size_t WebSettings::on_main_page_chunk(uint8_t *buffer, size_t maxLen, size_t index, MainPageChunkContext *context_ptr)
+    {
+        auto & context = *context_ptr;
+        size_t size(0);
+        if (index == 0)
+        {
+            context.fragment_offset = 0;
+        }
+
+        // Each state continues into the next as long as there is room, so that
+        // every chunk but the last is full.
+        switch (context.state)
+        {
+            case MainPageChunkState::BEGIN_PAGE:
+            {
+                // The asset links are versioned, so that browsers can cache them indefinitely.
+                static const char head_start[] PROGMEM =
+                    "<!DOCTYPE html>"
+                    "<meta http-equiv=\"X-UA-Compatible\" content=\"IE=edge,chrome=1\">"
+                    "<html>"
+                        "<link rel=\"stylesheet\" href=\"/style.css?v=";
+                static const char head_script[] PROGMEM =
+                        "\">"
+                        "<script language=\"javascript\" src=\"/script.js?v=";
+                static const char head_end[] PROGMEM =
+                        "\"></script>"
+                    "<body>"
                         "<div id=\"disable_overlay\" class=\"disable_overlay\"></div>"
                         "<div class=\"tab\">";
-                if (!send_static_string(buffer, maxLen, size, transition_script_to_body, context.sent_static_size))
+                HtmlWriter writer(buffer, maxLen, context.fragment_offset);
+                writer.write_P(head_start);
+                writer.write(style_css_etag.version(), 8);
+                writer.write_P(head_script);
+                writer.write(script_js_etag.version(), 8);
+                writer.write_P(head_end);
+                size += writer.size();
+                if (writer.overflowed())
                 {
+                    context.fragment_offset += writer.size();
                     break;
                 }
                 context.state = MainPageChunkState::TABBUTTON_HEADER;
-                context.sent_static_size = 0;
-                context.current_panel = setting_panels.begin();
-                context.current_setting = context.current_panel != setting_panels.end() ? setting_panels.front()->get_settings().begin() :
-                    SettingInterface::settings_list_t::const_iterator();
+                context.fragment_offset = 0;
+                context.current_panel = 0;
+            }
                 // FALL THROUGH
             case MainPageChunkState::TABBUTTON_HEADER:
-                if (!on_main_page_tabbutton_chunk(buffer, maxLen - 1, size, context))
+                if (!on_main_page_tabbutton_chunk(buffer, maxLen, size, context))
                 {
                     break;
                 }
                 context.state = MainPageChunkState::TAB_BODY;
-                context.sent_static_size = 0;
-                context.current_panel = setting_panels.begin();
-                context.current_setting = context.current_panel != setting_panels.end() ? setting_panels.front()->get_settings().begin() :
-                    SettingInterface::settings_list_t::const_iterator();
+                context.current_panel = 0;
                 context.starting_tab = true;
-                break;
+                // FALL THROUGH
             case MainPageChunkState::TAB_BODY:
-                if (!on_main_page_tabbody_chunk(buffer, maxLen - 1, size, context))
+                if (!on_main_page_tabbody_chunk(buffer, maxLen, size, context))
+                {
+                    break;
+                }
+                context.state = MainPageChunkState::FOOTER;
+                // Not necessary to reset other state values.
+                // FALL THROUGH.
+            case MainPageChunkState::FOOTER:
+                if (!on_main_page_footer_chunk(buffer, maxLen, size, context))
+                {
+                    break;
+                }
+                context.state = MainPageChunkState::DONE;
+                break;
+
+            case MainPageChunkState::DONE:
+                // Will return 0.
+                break;
+
+            default:
+            {
+                // Whoops.
+                static const char failure[] PROGMEM = "Internal error";
+                HtmlWriter writer(buffer, maxLen);
+                writer.write_P(failure);
+                size = writer.size();
+                context.state = MainPageChunkState::DONE;
+                break;
+            }
+        }
+
+        return size;
+    }
+
+    void WebSettings::add_setting_set(const __FlashStringHelper *name, const __FlashStringHelper *identifier, const SettingInterface::settings_list_t &list)
+    {
+        setting_panels.emplace_back(name, identifier, list);
+        build_field_index();
+        invalidate_page_cache();
+        schema_etag[0] = '\0';
+        events_resend = true;
+    }
+
+    void WebSettings::loop()
+    {
+        // Requests are asynchronous; only deferred work is done here.
+        if (page_cache_state == PageCacheState::STALE && is_setup)
+        {
+            update_page_cache();
+        }
+
+        InfoSettingHtml::refresh_in_background();
+
+        if (event_interval != 0 && events.count() != 0 && millis() - last_event_sample >= event_interval)
+        {
+            last_event_sample = millis();
+            send_events();
+        }
+
+        if (journal_pending && millis() - journal_change_time >= journal_delay)
+        {
+            flush_settings_journal();
+        }
+
+        // Uploaded firmware is written to flash here, one sector per call.
+        if (upload && upload->full_count != 0 && !upload->writing)
+        {
+            write_upload_buffer();
+        }
+    }
+
+    void WebSettings::send_events()
+    {
+        // Values are prepared before checking the version, as that may change the value.
+        bool send_all = events_resend;
+        events_resend = false;
+        static const SettingPanel::requested_settings_t all_settings;
+        String message;
+        for (const auto &panel: setting_panels)
+        {
+            bool panel_started = false;
+            for (const auto &setting: panel.get_settings())
+            {
+                if (!setting->is_dynamic() || !SettingPanel::is_sent(*setting, all_settings))
+                {
+                    continue;
+                }
+
+                setting->prepare_to_send();
+                if (!send_all && setting->get_version() <= event_version)
+                {
+                    continue;
+                }
+
+                // Same format as /settings/get.
+                if (!panel_started)
+                {
+                    message += message.isEmpty() ? '{' : ',';
+                    append_fragment(message, [&panel] (HtmlWriter &writer)
+                    {
+                        writer.write('"');
+                        writer.write_json_escaped(panel.get_identifier());
+                        writer.write(F("\":["));
+                    });
+                    panel_started = true;
+                }
+                else
+                {
+                    message += ',';
+                }
+                append_fragment(message, [&setting] (HtmlWriter &writer) { setting->write_json(writer); });
+            }
+
+            if (panel_started)
+            {
+                message += ']';
+            }
+        }
+
+        event_version = SettingInterface::get_current_version();
+        if (!message.isEmpty())
+        {
+            message += '}';
+            events.send(message.c_str(), "values");
+        }
+    }
+
+    bool WebSettings::render_main_page(const std::function<void(const uint8_t *, size_t)> &consumer)
+    {
+        std::unique_ptr<uint8_t[]> buffer(new uint8_t[page_cache_chunk_size]);
+        MainPageChunkContext context;
+        size_t index = 0;
+        size_t size;
+        while ((size = on_main_page_chunk(buffer.get(), page_cache_chunk_size, index, &context)) != 0)
+        {
+            consumer(buffer.get(), size);
+            index += size;
+            yield();
+        }
+
+        // Every piece can be split across chunks, so this only fails if the
+        // page could not be completed.
+        return context.state == MainPageChunkState::DONE;
+    }
+
+    void WebSettings::update_page_cache()
+    {
+        // First pass: compute the content hash, without touching the file system.
+        uint32_t crc = 0;
+        uint32_t length = 0;
+        if (!render_main_page([&crc, &length] (const uint8_t *data, size_t size)
+            {
+                crc = GzipWriter::update_crc(crc, data, size);
+                length += size;
+            }))
+        {
+            page_cache_state = PageCacheState::FAILED;
+            return;
+        }
+
+        // The gzip trailer holds the CRC and length of the content; if the
+        // stored page is the same, there is no need to rewrite it.
+        bool matches = false;
+        File existing = LittleFS.open(FPSTR(page_cache_path), "r");
+        if (existing && existing.size() > 18 && existing.seek(existing.size() - 8, SeekSet))
+        {
+            uint8_t trailer[8];
+            if (existing.read(trailer, sizeof(trailer)) == sizeof(trailer))
+            {
+                uint32_t stored_crc = trailer[0] | (trailer[1] << 8) | (trailer[2] << 16) | (static_cast<uint32_t>(trailer[3]) << 24);
+                uint32_t stored_length = trailer[4] | (trailer[5] << 8) | (trailer[6] << 16) | (static_cast<uint32_t>(trailer[7]) << 24);
+                matches = stored_crc == crc && stored_length == length;
+            }
+            page_cache_size = existing.size();
+        }
+        existing.close();
+
+        if (!matches)
+        {
+            // Second pass: write the compressed page. A temporary file is used so
+            // that a response still reading the previous page is not disturbed.
+            File file = LittleFS.open(FPSTR(page_cache_temp_path), "w");
+            if (!file)
+            {
+                page_cache_state = PageCacheState::FAILED;
+                return;
+            }
+
+            std::unique_ptr<GzipWriter> gzip(new GzipWriter(file));
+            bool written = render_main_page([&gzip] (const uint8_t *data, size_t size)
+                {
+                    gzip->write(data, size);
+                }) && gzip->finish() && gzip->get_crc() == crc;
+            gzip.reset();
+            page_cache_size = file.size();
+            file.close();
+
+            if (!written || !LittleFS.rename(FPSTR(page_cache_temp_path), FPSTR(page_cache_path)))
+            {
+                LittleFS.remove(FPSTR(page_cache_temp_path));
+                page_cache_state = PageCacheState::FAILED;
+                return;
+            }
+        }
+
+        snprintf_P(page_cache_etag, sizeof(page_cache_etag), PSTR("\"%08x\""), crc);
+        page_cache_state = PageCacheState::VALID;
+    }
+
+    bool WebSettings::send_page_cache(AsyncWebServerRequest *request, uint32_t start)
+    {
+        if (page_cache_state != PageCacheState::VALID)
+        {
+            return false;
+        }
+
+        if (request->hasHeader(F("If-None-Match")) && request->header(F("If-None-Match")) == page_cache_etag)
+        {
+            request->send(304);
+            metrics_response(MetricsEndpoint::MAIN_PAGE, start, 304, 0);
+            return true;
+        }
+
+        AsyncWebServerResponse *response = request->beginResponse(LittleFS, FPSTR(page_cache_path), TEXT_HTML);
+        if (response == nullptr)
+        {
+            // The file has gone; recreate it.
+            page_cache_state = PageCacheState::STALE;
+            return false;
+        }
+
+        response->addHeader(F("Content-Encoding"), F("gzip"));
+        response->addHeader(F("ETag"), page_cache_etag);
+        // The browser must check the ETag on every load, since panels can be added at any time.
+        response->addHeader(F("Cache-Control"), F("no-cache"));
+        request->send(response);
+        metrics_response(MetricsEndpoint::MAIN_PAGE, start, 200, page_cache_size);
+        return true;
+    }
+
+    size_t WebSettings::on_request_upload(AsyncWebServerRequest *request)
+    {
+        //!< @TODO This should have better styling.
+        static const char upload_page[] PROGMEM = "<!DOCTYPE html>"
+            "<link rel=\"stylesheet\" href=\"/style.css\">"
+            "<html><body><H1>Upload New Firmware</H1>"
+            "<form id='form' method='POST' action='/upload' enctype='multipart/form-data'>"
+            "<label for='md5'>MD5 digest (optional)</label><br><input type='text' name='md5' id='md5' maxlength='32' size='34'><br>"
+            "<label for='sha256'>SHA-256 digest (optional)</label><br><input type='text' name='sha256' id='sha256' maxlength='64' size='66'><br><br>"
+            "<input type='file' name='file' id='file' class='md_button ripple' accept='.bin,application/octet-stream' onchange=\"document.getElementById('sbmt').disabled = false\">"
+            "<br><br>"
+            "<input type='submit' disabled='true' value='Upload' id='sbmt' class='md_button ripple'>"
+            "<button type='button' onclick='document.location = \"/\"' class='md_button ripple red'> Cancel </button>"
+            "</form>";
+        request->send(200, TEXT_HTML, FPSTR(upload_page));
+        return sizeof(upload_page) - 1;
+    }
+
+    void WebSettings::handle_upload(AsyncWebServerRequest *request, String filename, size_t index, uint8_t *data, size_t len, bool final)
+    {
+        // Shamelessly adapted from tzapu/WiFiManager for Async web server
+
+        // handler for the file upload, gets the sketch bytes, and writes
+        // them through the Update object
+
+        // UPLOAD START
+        if (index == 0 && !start_upload(request))
+        {
+            return;
+        }
+        if (!upload || upload->request != request)
+        {
+            // The upload has failed, and the response has been sent.
+            return;
+        }
+
+        // UPLOAD WRITE
+        if (upload->failed)
+        {
+            fail_upload(request);
+            return;
+        }
+        if (len != 0)
+        {
+            if (metrics)
+            {
+                metrics->upload_bytes += len;
+            }
+            if (upload->check_sha256)
+            {
+                br_sha256_update(&upload->sha256_context, data, len);
+            }
+            if (!buffer_upload(data, len))
+            {
+                fail_upload(request);
+                return;
+            }
+        }
+
+        // UPLOAD FILE END
+        if (final)
+        {
+            // Write what remains; the partly filled buffer is the last.
+            while (upload->full_count != 0)
+            {
+                if (!write_upload_buffer())
+                {
+                    fail_upload(request);
+                    return;
+                }
+            }
+            if (upload->fill_size != 0 &&
+                Update.write(upload->buffers[upload->write_index].get(), upload->fill_size) != upload->fill_size)
+            {
+                fail_upload(request);
+                return;
+            }
+
+            if (upload->check_sha256)
+            {
+                uint8_t sha256[br_sha256_SIZE];
+                br_sha256_out(&upload->sha256_context, sha256);
+                if (memcmp(sha256, upload->sha256, sizeof(sha256)) != 0)
+                {
+                    fail_upload(request, F("The SHA-256 digest does not match."));
+                    return;
+                }
+            }
+
+            // This verifies the MD5 digest, if given.
+            if (!Update.end(true))
+            {
+                fail_upload(request);
+                return;
+            }
+            upload.reset();
+
+            // This also checks for general update errors as well.
+            on_update_done(request);
+        }
+
+        delay(0);
+    }
+
+    bool WebSettings::start_upload(AsyncWebServerRequest *request)
+    {
+        uint32_t start = metrics_request(MetricsEndpoint::UPLOAD);
+        if (upload)
+        {
+            on_update_failed(request, F("Another upload is in progress."));
+            return false;
+        }
+        if (metrics)
+        {
+            metrics->upload_start = start;
+        }
+
+        // The digests can be given as query parameters, or as form fields before the file.
+        static const char md5_name[] PROGMEM = "md5";
+        static const char sha256_name[] PROGMEM = "sha256";
+        const AsyncWebParameter *md5 = request->getParam(FPSTR(md5_name), true);
+        if (md5 == nullptr)
+        {
+            md5 = request->getParam(FPSTR(md5_name));
+        }
+        const AsyncWebParameter *sha256 = request->getParam(FPSTR(sha256_name), true);
+        if (sha256 == nullptr)
+        {
+            sha256 = request->getParam(FPSTR(sha256_name));
+        }
+
+        upload.reset(new UploadContext);
+        upload->request = request;
+        if (sha256 != nullptr && !sha256->value().isEmpty())
+        {
+            if (!parse_hex(sha256->value(), upload->sha256, sizeof(upload->sha256)))
+            {
+                upload.reset();
+                on_update_failed(request, F("The SHA-256 digest is not valid."));
+                return false;
+            }
+            upload->check_sha256 = true;
+            br_sha256_init(&upload->sha256_context);
+        }
+
+        // Buffers are only used if there are at least two, so that one can be filled while another is written.
+        for (uint8_t i = 0; i < upload_buffer_count; ++i)
+        {
+            std::unique_ptr<uint8_t[]> buffer(new (std::nothrow) uint8_t[upload_buffer_size]);
+            if (!buffer)
+            {
+                break;
+            }
+            upload->buffers.push_back(std::move(buffer));
+        }
+        if (upload->buffers.size() < 2)
+        {
+            upload->buffers.clear();
+        }
+
+        // An abandoned upload is discarded, so that another can be started.
+        request->onDisconnect([this, request] ()
+        {
+            on_request_disconnect(request);
+        });
+
+        uint32_t maxSketchSpace;
+
+#ifdef ESP8266
+        maxSketchSpace = (ESP.getFreeSketchSpace() - 0x1000) & 0xFFFFF000;
+#elif defined(ESP32)
+        // Think we do not need to stop WiFIUDP because we haven't started a listener
+        // maxSketchSpace = (ESP.getFlashChipSize() - 0x1000) & 0xFFFFF000;
+        // #define UPDATE_SIZE_UNKNOWN 0xFFFFFFFF // include update.h
+        maxSketchSpace = UPDATE_SIZE_UNKNOWN;
+#endif
+        // Required to run from AsyncWebServer.
+        Update.runAsync(true);
+
+        if (!Update.begin(maxSketchSpace))
+        {                 // start with max available size
+            fail_upload(request);
+            return false;
+        }
+        if (md5 != nullptr && !md5->value().isEmpty() && !Update.setMD5(md5->value().c_str()))
+        {
+            fail_upload(request, F("The MD5 digest is not valid."));
+            return false;
+        }
+        return true;
+    }
+
+    bool WebSettings::buffer_upload(const uint8_t *data, size_t len)
+    {
+        UploadContext &context = *upload;
+        if (context.buffers.empty())
+        {
+            return Update.write(const_cast<uint8_t *>(data), len) == len;
+        }
+
+        while (len != 0)
+        {
+            if (context.full_count == context.buffers.size())
+            {
+                // `loop` has not kept up; write the oldest buffer now.
+                if (context.writing || !write_upload_buffer())
+                {
+                    return false;
+                }
+            }
+            uint8_t *buffer = context.buffers[(context.write_index + context.full_count) % context.buffers.size()].get();
+            size_t count = std::min(len, upload_buffer_size - context.fill_size);
+            memcpy(&buffer[context.fill_size], data, count);
+            context.fill_size += count;
+            data += count;
+            len -= count;
+            if (context.fill_size == upload_buffer_size)
+            {
+                context.fill_size = 0;
+                ++context.full_count;
+            }
+        }
+        return true;
+    }
+
+    bool WebSettings::write_upload_buffer()
+    {
+        UploadContext &context = *upload;
+        context.writing = true;
+        bool written = Update.write(context.buffers[context.write_index].get(), upload_buffer_size) == upload_buffer_size;
+        context.writing = false;
+        context.write_index = (context.write_index + 1) % context.buffers.size();
+        --context.full_count;
+        if (!written)
+        {
+            context.failed = true;
+        }
+        return written;
+    }
+
+    void WebSettings::fail_upload(AsyncWebServerRequest *request, const __FlashStringHelper *reason)
+    {
+        on_update_failed(request, reason);
+        // The update is discarded, and the current firmware kept.
+        Update.end();
+        upload.reset();
+    }
+
+    void WebSettings::on_update_failed(AsyncWebServerRequest *request, const __FlashStringHelper *reason)
+    {
+        String page = F("<!DOCTYPE html><html>"
+            "<link rel=\"stylesheet\" href=\"/style.css\">"
+            "<body><h1>Upload Failed</h1>");
+        page += FPSTR(status_div);
+        page += F("<strong>Update Failed.</strong><Br/>Rebooting may clear the issue.<br/>");
+        if (reason != nullptr)
+        {
+            page += reason;
+        }
+        else
+        {
+#ifdef ESP32
+            page += "OTA Error: " + (String)Update.errorString();
+#else
+            page += F("Update Error Code: ");
+            page += Update.getError();
+#endif
+        }
+        page += TEXT_END_DIV;
+
+        page += F("</body></html>");
+
+        request->send(500, TEXT_HTML, page);
+        metrics_upload_response(500, page.length());
+    }
+
+    void WebSettings::on_update_done(AsyncWebServerRequest *request)
+    {
+        if (Update.hasError())
+        {
+            on_update_failed(request);
+            return;
+        }
+
+        // Shamelessly taken from tzapu/WiFiManager
+
+        String page = F("<!DOCTYPE html><html>"
+            "<link rel=\"stylesheet\" href=\"/style.css\">"
+            "<body><h1>Upload completed</h1>");
+        page += FPSTR(status_div);
+        page += F("Update completed; device is rebooting.</div></body></html>");
+
+        request->send(200, TEXT_HTML, page);
+        metrics_upload_response(200, page.length());
+
+        // Tell the main loop to restart; otherwise this won't
+        // send the reply.
+        if (restart_snapshot)
+        {
+            save_restart_snapshot();
+        }
+        on_restart(*this);
+    }
+
+    void WebSettings::on_request_values(AsyncWebServerRequest *request)
+    {
+        uint32_t start = metrics_request(MetricsEndpoint::SETTINGS_GET);
+        if (!admit_response(request, MetricsEndpoint::SETTINGS_GET, start, response_size_estimate(MetricsEndpoint::SETTINGS_GET), true))
+        {
+            return;
+        }
+        heap_request_start(values_heap);
+        // The context is in the request's response slot; it is released when the chunked-write
+        // completes, or when the client disconnects.
+        ValuesChunkContext *context = create_context<ValuesChunkContext>(request);
+
+        // Collect all 'tab' and 'setting' arguments. A tab of 'all' requests all panels,
+        // unless there is a panel with that identifier.
+        bool all_panels = false;
+        for (size_t i = 0; i < request->args(); ++i)
+        {
+            if (request->argName(i) == "setting")
+            {
+                SettingPanel::add_requested_setting(context->requested_settings, request->arg(i));
+            }
+            else if (request->argName(i) == "since")
+            {
+                context->has_since = true;
+                context->since = strtoul(request->arg(i).c_str(), nullptr, 10);
+            }
+            else if (request->argName(i) == "tab")
+            {
+                int panel = find_panel(request->arg(i));
+                if (panel >= 0)
+                {
+                    if (std::find(context->panels.begin(), context->panels.end(), panel) == context->panels.end())
+                    {
+                        context->panels.push_back(panel);
+                    }
+                }
+                else if (request->arg(i) == "all")
+                {
+                    all_panels = true;
+                }
+                else
+                {
+                    static const char no_tab[] PROGMEM = "Requested tab does not exist";
+                    release_response(request);
+                    request->send(400, TEXT_PLAIN, FPSTR(no_tab));
+                    heap_request_end(values_heap);
+                    metrics_response(MetricsEndpoint::SETTINGS_GET, start, 400, sizeof(no_tab) - 1);
+                    return;
+                }
+            }
+        }
+
+        if (all_panels)
+        {
+            context->panels.clear();
+            for (size_t panel = 0; panel < setting_panels.size(); ++panel)
+            {
+                context->panels.push_back(panel);
+            }
+        }
+        else if (context->panels.empty())
+        {
+            static const char tab_missing[] PROGMEM = "Query parameter 'tab' missing";
+            release_response(request);
+            request->send(400, TEXT_PLAIN, FPSTR(tab_missing));
+            heap_request_end(values_heap);
+            metrics_response(MetricsEndpoint::SETTINGS_GET, start, 400, sizeof(tab_missing) - 1);
+            return;
+        }
+
+        // Values are written directly into the response buffer, so memory use
+        // does not depend on the number of settings.
+        AsyncWebServerResponse *response = request->beginChunkedResponse(TEXT_JSON, [this, request, context, start] (uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+            heap_request_sample(values_heap);
+            size_t size = on_values_chunk(buffer, maxLen, *context);
+            metrics_chunk(MetricsEndpoint::SETTINGS_GET, size);
+            if (size == 0)
+            {
+                release_response(request);
+                heap_request_end(values_heap);
+                metrics_response(MetricsEndpoint::SETTINGS_GET, start, 200, 0);
+            }
+            return size;
+        });
+        response->addHeader("Cache-Control", "no-cache");
+        // Settings that change while the response is sent will also be in the next response.
+        response->addHeader(F("X-Settings-Version"), String(SettingInterface::get_current_version()));
+        request->send(response);
+    }
+
+    void WebSettings::heap_request_start(HeapUsage &usage)
+    {
+        if (heap_debug)
+        {
+            ++usage.requests;
+            usage.free_before = ESP.getFreeHeap();
+            usage.block_before = ESP.getMaxFreeBlockSize();
+            usage.free_low = std::min(usage.free_low, usage.free_before);
+            usage.block_low = std::min(usage.block_low, usage.block_before);
+        }
+    }
+
+    void WebSettings::heap_request_sample(HeapUsage &usage)
+    {
+        if (heap_debug)
+        {
+            usage.free_low = std::min(usage.free_low, ESP.getFreeHeap());
+            usage.block_low = std::min(usage.block_low, ESP.getMaxFreeBlockSize());
+        }
+    }
+
+    void WebSettings::heap_request_end(HeapUsage &usage)
+    {
+        if (heap_debug)
+        {
+            usage.free_after = ESP.getFreeHeap();
+            usage.block_after = ESP.getMaxFreeBlockSize();
+            usage.free_low = std::min(usage.free_low, usage.free_after);
+            usage.block_low = std::min(usage.block_low, usage.block_after);
+        }
+    }
+
+    void WebSettings::on_request_heap(AsyncWebServerRequest *request)
+    {
+        static const char current_format[] PROGMEM = "{\"free\":%u,\"max_block\":%u,\"fragmentation\":%u,\"requests\":{";
+        static const char usage_format[] PROGMEM = "\"%s\":{\"count\":%u,\"free_before\":%u,\"free_after\":%u,\"free_low\":%u,"
+            "\"block_before\":%u,\"block_after\":%u,\"block_low\":%u}";
+        static const char main_page_name[] PROGMEM = "/";
+        static const char values_name[] PROGMEM = "/settings/get";
+        static const char post_name[] PROGMEM = "/settings/set";
+        const std::pair<PGM_P, const HeapUsage *> usages[] = {
+            { main_page_name, &main_page_heap },
+            { values_name, &values_heap },
+            { post_name, &post_heap }
+        };
+
+        // Lows are reported as 0 until a request has been made.
+        char buffer[192];
+        String json;
+        json.reserve(512);
+        snprintf_P(buffer, sizeof(buffer), current_format, ESP.getFreeHeap(), ESP.getMaxFreeBlockSize(), ESP.getHeapFragmentation());
+        json += buffer;
+        for (const auto &usage: usages)
+        {
+            const HeapUsage &heap = *usage.second;
+            char name[16];
+            strncpy_P(name, usage.first, sizeof(name));
+            bool used = heap.requests != 0;
+            snprintf_P(buffer, sizeof(buffer), usage_format, name, heap.requests, heap.free_before, heap.free_after,
+                used ? heap.free_low : 0, heap.block_before, heap.block_after, used ? heap.block_low : 0);
+            if (&usage != &usages[0])
+            {
+                json += ',';
+            }
+            json += buffer;
+        }
+        json += F("}}");
+        AsyncWebServerResponse *response = request->beginResponse(200, TEXT_JSON, json);
+        response->addHeader(F("Cache-Control"), F("no-cache"));
+        request->send(response);
+    }
+
+    uint32_t WebSettings::metrics_request(MetricsEndpoint endpoint)
+    {
+        if (metrics)
+        {
+            ++metrics->endpoints[static_cast<size_t>(endpoint)].requests;
+        }
+        return micros();
+    }
+
+    void WebSettings::metrics_chunk(MetricsEndpoint endpoint, size_t size)
+    {
+        // The final, empty, chunk only ends the response; it is not counted.
+        if (metrics && size != 0)
+        {
+            auto &endpoint_metrics = metrics->endpoints[static_cast<size_t>(endpoint)];
+            ++endpoint_metrics.chunks;
+            endpoint_metrics.bytes += size;
+        }
+    }
+
+    void WebSettings::metrics_response(MetricsEndpoint endpoint, uint32_t start, int code, size_t bytes)
+    {
+        if (!metrics)
+        {
+            return;
+        }
+        auto &endpoint_metrics = metrics->endpoints[static_cast<size_t>(endpoint)];
+        ++endpoint_metrics.responses[std::min(std::max(code / 100 - 2, 0), 3)];
+        endpoint_metrics.bytes += bytes;
+
+        uint32_t latency = micros() - start;
+        size_t bucket = 0;
+        while (bucket < METRICS_LATENCY_BUCKETS - 1 && latency > pgm_read_dword(&metrics_latency_bounds[bucket]))
+        {
+            ++bucket;
+        }
+        ++endpoint_metrics.latency[bucket];
+        endpoint_metrics.latency_sum += latency;
+    }
+
+    void WebSettings::metrics_upload_response(int code, size_t bytes)
+    {
+        if (metrics)
+        {
+            metrics->upload_time += (micros() - metrics->upload_start) / 1000;
+            metrics_response(MetricsEndpoint::UPLOAD, metrics->upload_start, code, bytes);
+        }
+    }
+
+    void WebSettings::on_request_metrics(AsyncWebServerRequest *request)
+    {
+        // Metrics may have been disabled after "/metrics" was registered.
+        if (!metrics)
+        {
+            on_not_found(request);
+            return;
+        }
+
+        // The metrics are copied, so that a line is the same when it is resumed in the next chunk.
+        // Metrics do not take a response slot, so that they can be read while the device is busy;
+        // the context is owned by the response, so it is freed even if the client disconnects.
+        std::shared_ptr<MetricsChunkContext> context(new MetricsChunkContext{ *metrics });
+        context->metrics.slots_exhausted = response_slots_exhausted;
+        AsyncWebServerResponse *response = request->beginChunkedResponse(TEXT_METRICS, [context] (uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+            return on_metrics_chunk(buffer, maxLen, *context);
+        });
+        response->addHeader(F("Cache-Control"), F("no-cache"));
+        request->send(response);
+    }
+
+    size_t WebSettings::on_metrics_chunk(uint8_t *buffer, size_t maxLen, MetricsChunkContext &context)
+    {
+        size_t size = 0;
+        while (context.family < static_cast<size_t>(MetricFamily::COUNT))
+        {
+            HtmlWriter writer(&buffer[size], maxLen - size, context.fragment_offset);
+            if (!write_metrics_line(writer, context.metrics, context.family, context.line))
+            {
+                ++context.family;
+                context.line = 0;
+                continue;
+            }
+            size += writer.size();
+            if (writer.overflowed())
+            {
+                context.fragment_offset += writer.size();
+                break;
+            }
+            context.fragment_offset = 0;
+            ++context.line;
+        }
+        return size;
+    }
+
+    bool WebSettings::write_metrics_line(HtmlWriter &writer, const Metrics &metrics, size_t family, size_t line)
+    {
+        static const char help_start[] PROGMEM = "# HELP ";
+        static const char type_start[] PROGMEM = "# TYPE ";
+        static const char code_label[] PROGMEM = ",code=\"";
+        static const char le_label[] PROGMEM = ",le=\"";
+        static const char bucket_suffix[] PROGMEM = "_bucket";
+        static const char sum_suffix[] PROGMEM = "_sum";
+        static const char count_suffix[] PROGMEM = "_count";
+        constexpr size_t endpoint_count = static_cast<size_t>(MetricsEndpoint::COUNT);
+        constexpr size_t status_count = sizeof(metrics_status_labels) / sizeof(metrics_status_labels[0]);
+
+        // Each family has a help line and a type line, followed by its samples.
+        PGM_P name = read_pgm_pointer(metrics_names, family);
+        auto metric_family = static_cast<MetricFamily>(family);
+        if (line < 2)
+        {
+            writer.write_P(line == 0 ? help_start : type_start, 7);
+            writer.write_P(name, strlen_P(name));
+            if (line == 0)
+            {
+                PGM_P help = read_pgm_pointer(metrics_help, family);
+                writer.write_P(help, strlen_P(help));
+            }
+            else if (metric_family == MetricFamily::DURATION)
+            {
+                writer.write_P(metrics_type_histogram);
+            }
+            else
+            {
+                writer.write_P(metrics_type_counter);
+            }
+            return true;
+        }
+        size_t sample = line - 2;
+
+        // Totals without labels.
+        if (metric_family == MetricFamily::AUTH_CHALLENGES || metric_family == MetricFamily::UPLOAD_BYTES ||
+            metric_family == MetricFamily::UPLOAD_DURATION || metric_family == MetricFamily::SLOTS_EXHAUSTED)
+        {
+            if (sample != 0)
+            {
+                return false;
+            }
+            writer.write_P(name, strlen_P(name));
+            writer.write(' ');
+            if (metric_family == MetricFamily::AUTH_CHALLENGES)
+            {
+                writer.write_unsigned(metrics.auth_challenges);
+            }
+            else if (metric_family == MetricFamily::UPLOAD_BYTES)
+            {
+                writer.write_unsigned(metrics.upload_bytes);
+            }
+            else if (metric_family == MetricFamily::SLOTS_EXHAUSTED)
+            {
+                writer.write_unsigned(metrics.slots_exhausted);
+            }
+            else
+            {
+                write_seconds(writer, static_cast<uint64_t>(metrics.upload_time) * 1000);
+            }
+            writer.write('\n');
+            return true;
+        }
+
+        // Per endpoint samples.
+        size_t per_endpoint = 1;
+        if (metric_family == MetricFamily::RESPONSES)
+        {
+            per_endpoint = status_count;
+        }
+        else if (metric_family == MetricFamily::DURATION)
+        {
+            per_endpoint = METRICS_LATENCY_BUCKETS + 2;
+        }
+        size_t endpoint = sample / per_endpoint;
+        size_t part = sample % per_endpoint;
+        if (endpoint >= endpoint_count)
+        {
+            return false;
+        }
+        const EndpointMetrics &endpoint_metrics = metrics.endpoints[endpoint];
+        uint32_t value = 0;
+
+        writer.write_P(name, strlen_P(name));
+        if (metric_family == MetricFamily::DURATION)
+        {
+            if (part < METRICS_LATENCY_BUCKETS)
+            {
+                writer.write_P(bucket_suffix);
+            }
+            else if (part == METRICS_LATENCY_BUCKETS)
+            {
+                writer.write_P(sum_suffix);
+            }
+            else
+            {
+                writer.write_P(count_suffix);
+            }
+        }
+        writer.write('{');
+        PGM_P label = read_pgm_pointer(metrics_endpoint_labels, endpoint);
+        writer.write_P(label, strlen_P(label));
+        switch (metric_family)
+        {
+            case MetricFamily::REQUESTS:
+                value = endpoint_metrics.requests;
+                break;
+
+            case MetricFamily::RESPONSES:
+                writer.write_P(code_label);
+                writer.write_P(metrics_status_labels[part], 3);
+                writer.write('"');
+                value = endpoint_metrics.responses[part];
+                break;
+
+            case MetricFamily::RESPONSE_BYTES:
+                value = endpoint_metrics.bytes;
+                break;
+
+            case MetricFamily::RESPONSE_CHUNKS:
+                value = endpoint_metrics.chunks;
+                break;
+
+            default:
+                // Histogram buckets are cumulative.
+                for (size_t bucket = 0; bucket <= std::min(part, METRICS_LATENCY_BUCKETS - 1); ++bucket)
+                {
+                    value += endpoint_metrics.latency[bucket];
+                }
+                if (part < METRICS_LATENCY_BUCKETS)
+                {
+                    writer.write_P(le_label);
+                    writer.write_P(metrics_latency_labels[part], strlen_P(metrics_latency_labels[part]));
+                    writer.write('"');
+                }
+                break;
+        }
+        writer.write_P(PSTR("} "), 2);
+        if (metric_family == MetricFamily::DURATION && part == METRICS_LATENCY_BUCKETS)
+        {
+            write_seconds(writer, endpoint_metrics.latency_sum);
+        }
+        else
+        {
+            writer.write_unsigned(value);
+        }
+        writer.write('\n');
+        return true;
+    }
+
+    void WebSettings::on_request_schema(AsyncWebServerRequest *request)
+    {
+        uint32_t start = metrics_request(MetricsEndpoint::SETTINGS_SCHEMA);
+        if (schema_etag[0] == '\0')
+        {
+            // The schema only changes when panels are added; compute its CRC once.
+            uint8_t buffer[128];
+            SchemaChunkContext context;
+            uint32_t crc = 0;
+            size_t size;
+            while ((size = on_schema_chunk(buffer, sizeof(buffer), context)) != 0)
+            {
+                crc = GzipWriter::update_crc(crc, buffer, size);
+            }
+            snprintf_P(schema_etag, sizeof(schema_etag), PSTR("\"%08x\""), crc);
+        }
+
+        if (request->hasHeader(F("If-None-Match")) && request->header(F("If-None-Match")) == schema_etag)
+        {
+            request->send(304);
+            metrics_response(MetricsEndpoint::SETTINGS_SCHEMA, start, 304, 0);
+            return;
+        }
+
+        if (!admit_response(request, MetricsEndpoint::SETTINGS_SCHEMA, start, response_size_estimate(MetricsEndpoint::SETTINGS_SCHEMA), true))
+        {
+            return;
+        }
+
+        // The context is in the request's response slot; it is released when the chunked-write
+        // completes, or when the client disconnects.
+        SchemaChunkContext *context = create_context<SchemaChunkContext>(request);
+        AsyncWebServerResponse *response = request->beginChunkedResponse(TEXT_JSON, [this, request, context, start] (uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+            size_t size = on_schema_chunk(buffer, maxLen, *context);
+            metrics_chunk(MetricsEndpoint::SETTINGS_SCHEMA, size);
+            if (size == 0)
+            {
+                release_response(request);
+                metrics_response(MetricsEndpoint::SETTINGS_SCHEMA, start, 200, 0);
+            }
+            return size;
+        });
+        response->addHeader(F("ETag"), schema_etag);
+        response->addHeader(F("Cache-Control"), F("no-cache"));
+        request->send(response);
+    }
+
+    bool WebSettings::admit_response(AsyncWebServerRequest *request, MetricsEndpoint endpoint, uint32_t start, size_t size, bool needs_slot)
+    {
+        ResponseSlot *slot = nullptr;
+        if (needs_slot)
+        {
+            for (size_t i = 0; i < response_limit && slot == nullptr; ++i)
+            {
+                if (response_slots[i].request == nullptr)
                 {
-                    break;
+                    slot = &response_slots[i];
                 }
-                context.state = MainPageChunkState::FOOTER;
-                // Not necessary to reset other state values.
-                // FALL THROUGH.
-            case MainPageChunkState::FOOTER:
-                if (!on_main_page_footer_chunk(buffer, maxLen - 1, size, context))
+            }
+            if (slot == nullptr)
+            {
+                ++response_slots_exhausted;
+            }
+        }
+
+        // The server buffers at most a send buffer of the response at a time.
+        size_t heap_cost = response_heap_cost + std::min(size, response_send_buffer);
+        if ((!needs_slot || slot != nullptr) && ESP.getMaxFreeBlockSize() >= heap_cost + response_heap_reserve)
+        {
+            if (slot != nullptr)
+            {
+                // The slot is released when the connection closes, if the response has not completed.
+                slot->request = request;
+                request->onDisconnect([this, request] ()
                 {
-                    break;
-                }
-                context.state = MainPageChunkState::DONE;
-                break;
+                    on_request_disconnect(request);
+                });
+            }
+            return true;
+        }
 
-            case MainPageChunkState::DONE:
-                // Will return 0.
-                if (size == 0)
+        // The main page is loaded by the browser itself, which does not retry; it is asked to reload.
+        static const char busy_page[] PROGMEM =
+            "<!DOCTYPE html><html><meta http-equiv=\"refresh\" content=\"2\"><body>Busy; this page will reload shortly.</body></html>";
+        static const char busy[] PROGMEM = "Busy; try again shortly";
+        AsyncWebServerResponse *response;
+        size_t length;
+        if (endpoint == MetricsEndpoint::MAIN_PAGE)
+        {
+            response = request->beginResponse_P(503, TEXT_HTML, busy_page);
+            length = sizeof(busy_page) - 1;
+        }
+        else
+        {
+            response = request->beginResponse_P(503, TEXT_PLAIN, busy);
+            length = sizeof(busy) - 1;
+        }
+        response->addHeader(F("Retry-After"), F("2"));
+        response->addHeader(F("Cache-Control"), F("no-store"));
+        request->send(response);
+        metrics_response(endpoint, start, 503, length);
+        return false;
+    }
+
+    size_t WebSettings::response_size_estimate(MetricsEndpoint endpoint) const
+    {
+        switch (endpoint)
+        {
+            case MetricsEndpoint::MAIN_PAGE:
+                if (page_cache_state == PageCacheState::VALID)
                 {
-                    delete context_ptr;
+                    return page_cache_size;
                 }
-                break;
+                // The tab buttons, and the first panel; the others are built by the browser.
+                return main_page_base_size + setting_panels.size() * main_page_tab_size +
+                    (setting_panels.empty() ? 0 : setting_panels.front().get_settings().size() * main_page_setting_size);
+
+            case MetricsEndpoint::STYLE_CSS:
+                return assets::style_css_gz_length;
+
+            case MetricsEndpoint::SCRIPT_JS:
+                return assets::script_js_gz_length;
+
+            case MetricsEndpoint::SETTINGS_SCHEMA:
+                return schema_base_size + field_setting_count * schema_setting_size;
+
+            case MetricsEndpoint::SETTINGS_GET:
+                // All tabs; requests for fewer are smaller.
+                return values_base_size + setting_panels.size() * values_tab_size + field_setting_count * values_setting_size;
 
             default:
-                // Whoops.
-                static const char failure[] PROGMEM = "Internal error";
-                buffer_append(buffer, failure, size, maxLen);
-                context.state = MainPageChunkState::DONE;
-                break;
+                return 0;
         }
-
-        return size;
     }
 
-    void WebSettings::add_setting_set(const __FlashStringHelper *name, const __FlashStringHelper *identifier, const SettingInterface::settings_list_t &list)
+    template<typename T>
+    T *WebSettings::create_context(AsyncWebServerRequest *request)
     {
-        setting_panels.emplace_back(std::make_unique<SettingPanel>(name, identifier, list));
+        for (size_t i = 0; i < response_limit; ++i)
+        {
+            ResponseSlot &slot = response_slots[i];
+            if (slot.request == request)
+            {
+                slot.destroy = [] (void *context)
+                {
+                    static_cast<T *>(context)->~T();
+                };
+                return new (slot.storage) T;
+            }
+        }
+        return nullptr;
     }
 
-    void WebSettings::loop()
+    void WebSettings::release_response(AsyncWebServerRequest *request)
     {
-        // Asynchronous, nothing to see here. This is not the loop you are looking for.
+        for (size_t i = 0; i < response_limit; ++i)
+        {
+            ResponseSlot &slot = response_slots[i];
+            if (slot.request == request)
+            {
+                if (slot.destroy != nullptr)
+                {
+                    slot.destroy(slot.storage);
+                    slot.destroy = nullptr;
+                }
+                slot.request = nullptr;
+                return;
+            }
+        }
     }
 
-    void WebSettings::on_request_upload(AsyncWebServerRequest *request)
+    void WebSettings::on_request_disconnect(AsyncWebServerRequest *request)
     {
-        //!< @TODO This should have better styling.
-        request->send(200, TEXT_HTML, F("<!DOCTYPE html>"
-            "<link rel=\"stylesheet\" href=\"/style.css\">"
-            "<html><body><H1>Upload New Firmware</H1>"
-            "<form id='form' method='POST' action='/upload' enctype='multipart/form-data'>"
-            "<input type='file' name='file' id='file' class='md_button ripple' accept='.bin,application/octet-stream' onchange=\"document.getElementById('sbmt').disabled = false\">"
-            "<br><br>"
-            "<input type='submit' disabled='true' value='Upload' id='sbmt' class='md_button ripple'>"
-            "<button type='button' onclick='document.location = \"/\"' class='md_button ripple red'> Cancel </button>"
-            "</form>"));
+        release_response(request);
+        if (upload && upload->request == request)
+        {
+            Update.end();
+            upload.reset();
+        }
     }
 
-    void WebSettings::handle_upload(AsyncWebServerRequest *request, String filename, size_t index, uint8_t *data, size_t len, bool final)
+    int WebSettings::find_panel(const String &identifier) const
     {
-        // Shamelessly adapted from tzapu/WiFiManager for Async web server
+        // Panels are indexed by their marker field name, `identifier$`.
+        uint32_t hash = name_hash::update(name_hash::hash(identifier.c_str(), identifier.length()), '$');
+        auto entry = find_field(hash);
+        for (; entry != field_index.end() && entry->hash == hash; ++entry)
+        {
+            if (entry->setting == nullptr &&
+                strcmp_P(identifier.c_str(), reinterpret_cast<PGM_P>(setting_panels[entry->panel].get_identifier())) == 0)
+            {
+                return entry->panel;
+            }
+        }
+        return -1;
+    }
 
-        // handler for the file upload, gets the sketch bytes, and writes
-        // them through the Update object
+    std::vector<WebSettings::FieldIndexEntry>::const_iterator WebSettings::find_field(uint32_t hash) const
+    {
+        return std::lower_bound(field_index.begin(), field_index.end(), hash, [] (const FieldIndexEntry &e, uint32_t h)
+        {
+            return e.hash < h;
+        });
+    }
 
-        // UPLOAD START
-        if (index == 0)
+    void WebSettings::build_field_index()
+    {
+        field_index.clear();
+        uint16_t panel_position = 0;
+        uint16_t setting_position = 0;
+        for (const auto &panel: setting_panels)
+        {
+            uint32_t prefix_hash = field_prefix_hash(panel);
+            field_index.push_back({ prefix_hash, nullptr, panel_position, 0 });
+            for (auto setting: panel.get_settings())
+            {
+                uint32_t hash = name_hash::update_P(prefix_hash, reinterpret_cast<PGM_P>(setting->name()));
+                field_index.push_back({ hash, setting, panel_position, setting_position });
+                ++setting_position;
+            }
+            ++panel_position;
+        }
+        field_setting_count = setting_position;
+        field_index.shrink_to_fit();
+        std::sort(field_index.begin(), field_index.end(), [] (const FieldIndexEntry &a, const FieldIndexEntry &b)
         {
-            uint32_t maxSketchSpace;
+            return a.hash < b.hash;
+        });
+    }
+    void WebSettings::on_post_settings(AsyncWebServerRequest *request)
+    {
+        // Values found for each setting, by position; and the panels whose markers were found.
+        std::vector<const String *> values(field_setting_count, nullptr);
+        std::vector<bool> panel_present(setting_panels.size(), false);
+        bool any_marker = false;
 
-#ifdef ESP8266
-            maxSketchSpace = (ESP.getFreeSketchSpace() - 0x1000) & 0xFFFFF000;
-#elif defined(ESP32)
-            // Think we do not need to stop WiFIUDP because we haven't started a listener
-            // maxSketchSpace = (ESP.getFlashChipSize() - 0x1000) & 0xFFFFF000;
-            // #define UPDATE_SIZE_UNKNOWN 0xFFFFFFFF // include update.h
-            maxSketchSpace = UPDATE_SIZE_UNKNOWN;
-#endif
-            // Required to run from AsyncWebServer.
-            Update.runAsync(true);
+        for (size_t i = 0; i < request->params(); ++i)
+        {
+            const AsyncWebParameter *param = request->getParam(i);
+            if (param->isFile())
+            {
+                continue;
+            }
+            const String &field = param->name();
+            uint32_t hash = name_hash::hash(field.c_str(), field.length());
+            auto entry = find_field(hash);
+            for (; entry != field_index.end() && entry->hash == hash; ++entry)
+            {
+                // Verify the name, in case of a hash collision.
+                const auto &panel = setting_panels[entry->panel];
+                size_t identifier_length = panel.get_identifier_length();
+                if (field.length() <= identifier_length || field[identifier_length] != '$' ||
+                    strncmp_P(field.c_str(), reinterpret_cast<PGM_P>(panel.get_identifier()), identifier_length) != 0)
+                {
+                    continue;
+                }
+                const char *setting_name = field.c_str() + identifier_length + 1;
+                if (entry->setting == nullptr)
+                {
+                    if (*setting_name == '\0')
+                    {
+                        panel_present[entry->panel] = true;
+                        any_marker = true;
+                        break;
+                    }
+                }
+                else if (strcmp_P(setting_name, reinterpret_cast<PGM_P>(entry->setting->name())) == 0)
+                {
+                    // As with `arg()`, the first of repeated fields is used.
+                    if (values[entry->position] == nullptr)
+                    {
+                        values[entry->position] = &param->value();
+                    }
+                    break;
+                }
+            }
+        }
 
-            if (!Update.begin(maxSketchSpace))
-            {                 // start with max available size
-                on_update_failed(request);
-                Update.end();
-                return;
+        // Panels that were never opened in the browser are not in the form. If
+        // there are no panel markers at all, the request predates them; update all panels.
+        // Settings that do not appear are set to their defaults, unless they are not sent
+        // to the UI (i.e. passwords).
+        size_t panel_position = 0;
+        size_t setting_position = 0;
+        for (const auto &panel: setting_panels)
+        {
+            if (any_marker && !panel_present[panel_position])
+            {
+                setting_position += panel.get_settings().size();
+                ++panel_position;
+                continue;
+            }
+            for (auto setting: panel.get_settings())
+            {
+                const String *value = setting_position < values.size() ? values[setting_position] : nullptr;
+                if (value != nullptr)
+                {
+                    setting->set_from_post(*value);
+                }
+                else if (setting->send_to_ui())
+                {
+                    setting->set_default();
+                }
+                ++setting_position;
             }
+            ++panel_position;
         }
+    }
 
-        // UPLOAD WRITE
-        if (len != 0)
+    WebSettings::changes_t WebSettings::get_changes_since(uint32_t version) const
+    {
+        changes_t changes;
+        for (const auto &panel: setting_panels)
         {
-            if (Update.write(data, len) != len)
+            bool panel_started = false;
+            for (auto setting: panel.get_settings())
             {
-                on_update_failed(request);
-                Update.end();
-                return;
+                if (setting->get_version() <= version)
+                {
+                    continue;
+                }
+                if (!panel_started)
+                {
+                    changes.push_back(PanelChanges{ panel.get_identifier(), {} });
+                    panel_started = true;
+                }
+                changes.back().settings.push_back(setting);
             }
         }
+        return changes;
+    }
 
-        // UPLOAD FILE END
-        if (final)
+    bool WebSettings::write_settings_segment(Print &output, bool all, uint32_t since) const
+    {
+        // Records: key, type, and value length, followed by the value. The segment header
+        // holds the length and CRC of the records, so they are visited twice; once to
+        // compute the header, and once to write them.
+        auto for_each_record = [this, all, since] (const auto &record_output)
         {
-            if (!Update.end(true))
+            for (const auto &panel: setting_panels)
             {
-                on_update_failed(request);
-                return;
+                uint32_t prefix_hash = field_prefix_hash(panel);
+                for (auto setting: panel.get_settings())
+                {
+                    const void *value;
+                    size_t value_length;
+                    bool included = setting->is_persistable() && (all || setting->get_version() > since);
+                    StorageType type = included ? setting->get_stored(value, value_length) : StorageType::NONE;
+                    if (type == StorageType::NONE || value_length > UINT16_MAX)
+                    {
+                        continue;
+                    }
+                    uint8_t record[storage_record_size];
+                    put_uint32(record, name_hash::update_P(prefix_hash, reinterpret_cast<PGM_P>(setting->name())));
+                    record[4] = static_cast<uint8_t>(type);
+                    record[5] = static_cast<uint8_t>(value_length);
+                    record[6] = static_cast<uint8_t>(value_length >> 8);
+                    record_output(record, sizeof(record));
+                    record_output(static_cast<const uint8_t *>(value), value_length);
+                }
             }
+        };
 
-            // This also checks for general update errors as well.
-            on_update_done(request);
+        uint32_t crc = 0;
+        uint32_t length = 0;
+        for_each_record([&crc, &length] (const uint8_t *data, size_t size)
+        {
+            crc = GzipWriter::update_crc(crc, data, size);
+            length += size;
+        });
+        if (length == 0)
+        {
+            return true;
         }
 
-        delay(0);
+        uint8_t segment[storage_segment_size];
+        put_uint32(segment, length);
+        put_uint32(&segment[4], crc);
+        bool written = output.write(segment, sizeof(segment)) == sizeof(segment);
+        for_each_record([&output, &written] (const uint8_t *data, size_t size)
+        {
+            written = written && output.write(data, size) == size;
+        });
+        return written;
     }
 
-    void WebSettings::on_update_failed(AsyncWebServerRequest *request)
+    bool WebSettings::save_settings(FS &fs, const String &path) const
     {
-        String page = F("<!DOCTYPE html><html>"
-            "<link rel=\"stylesheet\" href=\"/style.css\">"
-            "<body><h1>Upload Failed</h1>");
-        page += FPSTR(status_div);
-        page += F("<strong>Update Failed.</strong><Br/>Rebooting may clear the issue.<br/>");
-#ifdef ESP32
-        page += "OTA Error: " + (String)Update.errorString();
-#else
-        page += F("Update Error Code: ");
-        page += Update.getError();
-#endif
-        page += TEXT_END_DIV;
+        String temp_path(path);
+        temp_path += F(".tmp");
+        File file = fs.open(temp_path, "w");
+        if (!file)
+        {
+            return false;
+        }
 
-        page += F("</body></html>");
+        uint8_t header[storage_header_size] = {};
+        memcpy_P(header, storage_magic, 4);
+        header[4] = storage_format_version;
+        bool written = file.write(header, sizeof(header)) == sizeof(header) && write_settings_segment(file, true, 0);
+        file.close();
 
-        request->send(500, TEXT_HTML, page);
+        if (!written || !fs.rename(temp_path, path))
+        {
+            fs.remove(temp_path);
+            return false;
+        }
+        return true;
     }
 
-    void WebSettings::on_update_done(AsyncWebServerRequest *request)
+    bool WebSettings::load_settings(FS &fs, const String &path)
     {
-        if (Update.hasError())
+        File file = fs.open(path, "r");
+        uint8_t header[storage_header_size];
+        if (!file || file.read(header, sizeof(header)) != sizeof(header) ||
+            memcmp_P(header, storage_magic, 4) != 0 || header[4] != storage_format_version)
         {
-            on_update_failed(request);
-            return;
+            return false;
         }
 
-        // Shamelessly taken from tzapu/WiFiManager
+        // Segments are applied in order, so that values appended later replace earlier ones.
+        // Each is verified before it is applied, so that a damaged segment changes nothing.
+        size_t file_size = file.size();
+        size_t position = sizeof(header);
+        uint8_t buffer[64];
+        while (file_size - position >= storage_segment_size)
+        {
+            uint8_t segment[storage_segment_size];
+            if (file.read(segment, sizeof(segment)) != sizeof(segment))
+            {
+                break;
+            }
+            position += sizeof(segment);
+            uint32_t length = get_uint32(segment);
+            auto read = [&file] (uint8_t *data, size_t size)
+            {
+                return file.read(data, size) == size;
+            };
+            if (length > file_size - position || !check_file_crc(file, length, get_uint32(&segment[4]), buffer, sizeof(buffer)) ||
+                !apply_settings_segment(read, length))
+            {
+                break;
+            }
+            position += length;
+        }
+        return true;
+    }
 
-        String page = F("<!DOCTYPE html><html>"
-            "<link rel=\"stylesheet\" href=\"/style.css\">"
-            "<body><h1>Upload completed</h1>");
-        page += FPSTR(status_div);
-        page += F("Update completed; device is rebooting.</div></body></html>");
+    bool WebSettings::apply_settings_segment(const std::function<bool(uint8_t *, size_t)> &read, uint32_t length)
+    {
+        // Almost all values fit in `buffer`.
+        uint8_t buffer[64];
+        for (uint32_t position = 0; position < length; )
+        {
+            uint8_t record[storage_record_size];
+            if (length - position < sizeof(record) || !read(record, sizeof(record)))
+            {
+                return false;
+            }
+            position += sizeof(record);
+            uint32_t key = get_uint32(record);
+            auto type = static_cast<StorageType>(record[4]);
+            size_t value_length = record[5] | (record[6] << 8);
+            if (length - position < value_length)
+            {
+                return false;
+            }
 
-        request->send(200, TEXT_HTML, page);
+            std::unique_ptr<uint8_t[]> large_value;
+            uint8_t *value = buffer;
+            if (value_length > sizeof(buffer))
+            {
+                large_value.reset(new uint8_t[value_length]);
+                value = large_value.get();
+            }
+            if (!read(value, value_length))
+            {
+                return false;
+            }
+            position += value_length;
 
-        // Tell the main loop to restart; otherwise this won't
-        // send the reply.
-        on_restart(*this);
+            for (auto entry = find_field(key); entry != field_index.end() && entry->hash == key; ++entry)
+            {
+                if (entry->setting != nullptr && entry->setting->is_persistable() &&
+                    entry->setting->set_from_stored(type, value, value_length))
+                {
+                    break;
+                }
+            }
+        }
+        return true;
     }
 
-    void WebSettings::on_request_values(AsyncWebServerRequest *request)
+    void WebSettings::set_settings_journal(FS &fs, const String &path, uint32_t save_delay, size_t compact_size)
+    {
+        journal_fs = &fs;
+        journal_path = path;
+        journal_delay = save_delay;
+        journal_compact_size = compact_size;
+        journal_version = SettingInterface::get_current_version();
+        // The file may end with a damaged segment, after which nothing could be read back.
+        journal_compact = true;
+    }
+
+    void WebSettings::schedule_settings_save()
     {
-        if (!request->hasArg("tab"))
+        if (journal_fs != nullptr)
         {
-            request->send(400, TEXT_PLAIN, F("Query parameter 'tab' missing"));
+            journal_change_time = millis();
+            journal_pending = true;
         }
+    }
 
-        auto & tab = request->arg("tab");
-        // Collect all 'setting' arguments.
-        std::vector<const String *> requested_settings;
-        requested_settings.reserve(request->args());
-        int tabParameterCount(0);
-        for (size_t i = 0; i < request->args(); ++i)
+    bool WebSettings::flush_settings_journal()
+    {
+        if (journal_fs == nullptr || !journal_pending)
         {
-            if (request->argName(i) == "setting")
-            {
-                requested_settings.push_back(&request->arg(i));
-            }
-            if (request->argName(i) == "tab")
+            return true;
+        }
+        journal_pending = false;
+
+        uint32_t version = SettingInterface::get_current_version();
+        bool saved = false;
+        if (!journal_compact)
+        {
+            File file = journal_fs->open(journal_path, "a");
+            if (file && file.size() >= storage_header_size && file.size() < journal_compact_size)
             {
-                ++tabParameterCount;
+                saved = write_settings_segment(file, false, journal_version);
             }
         }
-        if (tabParameterCount != 1)
+        // A failed append may have left a partial segment; rewriting the file removes it.
+        if (!saved)
         {
-            request->send(400, TEXT_PLAIN, F("More than one query parameter 'tab' is not supported"));
+            saved = save_settings(*journal_fs, journal_path);
         }
-        auto target_panel = std::find_if(setting_panels.begin(), setting_panels.end(), [&tab] (const std::unique_ptr<SettingPanel> &panel)
+
+        journal_compact = !saved;
+        if (saved)
         {
-            return strcmp_P(tab.c_str(), reinterpret_cast<const char *>(panel->get_identifier())) == 0;
-        });
-        if (target_panel == setting_panels.end())
+            journal_version = version;
+        }
+        else
         {
-            request->send(400, TEXT_PLAIN, F("Requested tab does not exist"));
-            return;
+            schedule_settings_save();
+        }
+        return saved;
+    }
+
+    bool WebSettings::save_restart_snapshot() const
+    {
+        // The snapshot has the same layout as a settings file with a single segment.
+        uint32_t snapshot[snapshot_size / sizeof(uint32_t)] = {};
+        uint8_t *bytes = reinterpret_cast<uint8_t *>(snapshot);
+        BufferPrint output(bytes, sizeof(snapshot));
+        uint8_t header[storage_header_size] = {};
+        memcpy_P(header, storage_magic, 4);
+        header[4] = storage_format_version;
+        output.write(header, sizeof(header));
+        if (!write_settings_segment(output, true, 0) || output.size() == sizeof(header))
+        {
+            // Clear any earlier snapshot; it would be out of date.
+            snapshot[0] = 0;
+            ESP.rtcUserMemoryWrite(snapshot_rtc_offset, snapshot, sizeof(uint32_t));
+            return false;
         }
+        size_t size = (output.size() + sizeof(uint32_t) - 1) & ~(sizeof(uint32_t) - 1);
+        return ESP.rtcUserMemoryWrite(snapshot_rtc_offset, snapshot, size);
+    }
 
-        // The request->send() deletes the response when done.
-        // Allocate 128 bytes per setting in the panel. For the panel
-        // with the most settings in esp8266_device_framework, which is 13 settings,
-        // that works out to 1792 bytes.
-        auto response = new AsyncJsonResponse(false, 128 * (*target_panel)->get_settings().size());
-        auto & root = response->getRoot();
-        root[(*target_panel)->get_identifier()] = (*target_panel)->as_json(requested_settings);
-        response->setLength();
-        response->addHeader("Cache-Control", "no-cache");
-        request->send(response);
+    bool WebSettings::restore_restart_snapshot()
+    {
+        // RTC memory is kept across a restart, but not a power cycle; a snapshot
+        // is only used after a software restart, and only once.
+        const rst_info *reset_info = ESP.getResetInfoPtr();
+        if (reset_info == nullptr || reset_info->reason != REASON_SOFT_RESTART)
+        {
+            return false;
+        }
+
+        uint32_t snapshot[snapshot_size / sizeof(uint32_t)];
+        uint8_t *bytes = reinterpret_cast<uint8_t *>(snapshot);
+        constexpr size_t prefix_size = storage_header_size + storage_segment_size;
+        if (!ESP.rtcUserMemoryRead(snapshot_rtc_offset, snapshot, prefix_size) ||
+            memcmp_P(bytes, storage_magic, 4) != 0 || bytes[4] != storage_format_version)
+        {
+            return false;
+        }
+        uint32_t zero = 0;
+        ESP.rtcUserMemoryWrite(snapshot_rtc_offset, &zero, sizeof(zero));
+
+        uint32_t length = get_uint32(&bytes[storage_header_size]);
+        size_t size = (prefix_size + length + sizeof(uint32_t) - 1) & ~(sizeof(uint32_t) - 1);
+        if (length > sizeof(snapshot) - prefix_size ||
+            !ESP.rtcUserMemoryRead(snapshot_rtc_offset, snapshot, size) ||
+            GzipWriter::update_crc(0, &bytes[prefix_size], length) != get_uint32(&bytes[storage_header_size + 4]))
+        {
+            return false;
+        }
+
+        const uint8_t *next = &bytes[prefix_size];
+        auto read = [&next] (uint8_t *data, size_t size)
+        {
+            memcpy(data, next, size);
+            next += size;
+            return true;
+        };
+        return apply_settings_segment(read, length);
     }
 
     void WebSettings::on_not_found(AsyncWebServerRequest *request)
@@ -1100,6 +2750,10 @@ namespace grmcdorman
             if (!request->authenticate(last_auth_digest.c_str()))
             {
                 request->requestAuthentication(auth_realm);
+                if (metrics)
+                {
+                    ++metrics->auth_challenges;
+                }
                 return false;
             }
         }
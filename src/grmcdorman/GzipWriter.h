@@ -0,0 +1,116 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <Print.h>
+
+namespace grmcdorman
+{
+    /**
+     * @brief A streaming gzip compressor.
+     *
+     * This compresses data written to it and sends the gzip stream to an output
+     * (typically a file). It uses LZ77 over a small window and the fixed deflate Huffman
+     * codes, trading compression ratio for memory; for HTML this is usually
+     * a reduction of 3 to 4 times.
+     *
+     * The object is large (about 5K); allocate it on the heap, and only for as long as needed.
+     */
+    class GzipWriter
+    {
+    public:
+        /**
+         * @brief Construct a new gzip writer.
+         *
+         * The gzip header is written to the output immediately.
+         *
+         * @param output    The destination for the compressed data.
+         */
+        explicit GzipWriter(Print &output);
+
+        /**
+         * @brief Compress a block of data.
+         *
+         * @param data      Data to compress.
+         * @param length    Length of the data.
+         */
+        void write(const uint8_t *data, size_t length);
+
+        /**
+         * @brief Complete the gzip stream.
+         *
+         * This compresses any pending data and writes the gzip trailer. No further
+         * data may be written.
+         *
+         * @return `true` if all output was written successfully.
+         */
+        bool finish();
+
+        /**
+         * @brief Get the CRC-32 of the uncompressed data written so far.
+         *
+         * This is the same value recorded in the gzip trailer.
+         *
+         * @return CRC-32 value.
+         */
+        uint32_t get_crc() const
+        {
+            return ~crc;
+        }
+
+        /**
+         * @brief Get the total number of uncompressed bytes written.
+         *
+         * @return Uncompressed size.
+         */
+        uint32_t get_input_size() const
+        {
+            return input_size;
+        }
+
+        /**
+         * @brief Update a CRC-32 (as used by gzip) with a block of data.
+         *
+         * The initial value is 0, and the result of one call can be passed as `crc`
+         * in the next.
+         *
+         * @param crc       The CRC so far.
+         * @param data      Data to include.
+         * @param length    Length of the data.
+         * @return Updated CRC.
+         */
+        static uint32_t update_crc(uint32_t crc, const uint8_t *data, size_t length);
+
+    private:
+        static constexpr size_t WINDOW_SIZE = 1024;     //!< The LZ77 window size; a power of two.
+        static constexpr size_t HASH_SIZE = 512;        //!< The hash table size; a power of two.
+        static constexpr size_t MIN_MATCH = 3;          //!< The shortest match deflate can encode.
+        static constexpr size_t MAX_MATCH = 258;        //!< The longest match deflate can encode.
+        static constexpr int MAX_CHAIN = 16;            //!< Maximum hash chain entries examined per position.
+
+        void compress(bool flush);                      //!< Encode buffered input; all of it if `flush`, otherwise leaving `MAX_MATCH` of lookahead.
+        void slide();                                   //!< Move the upper half of the window down.
+        void insert_hash(size_t position);              //!< Record `position` in the hash chains.
+        void put_bits(uint32_t value, uint8_t count);   //!< Append bits, least significant first.
+        void put_code(uint16_t code, uint8_t count);    //!< Append a Huffman code, most significant first.
+        void put_literal(uint16_t symbol);              //!< Append a fixed-Huffman literal/length symbol.
+        void put_match(size_t length, size_t distance); //!< Append a length/distance pair.
+        void put_byte(uint8_t value);                   //!< Append a byte to the output buffer.
+        void flush_output();                            //!< Send the output buffer.
+
+        Print &output;                      //!< The compressed output.
+        uint32_t crc;                       //!< Running (inverted) CRC of the input.
+        uint32_t input_size;                //!< Total bytes of input.
+        bool output_error;                  //!< Set if the output did not accept all data.
+        uint32_t bit_buffer;                //!< Pending output bits.
+        uint8_t bit_count;                  //!< Number of bits in `bit_buffer`.
+        size_t position;                    //!< Next position in `window` to be encoded.
+        size_t window_end;                  //!< End of the valid data in `window`.
+        size_t output_used;                 //!< Bytes in `output_buffer`.
+        uint8_t output_buffer[64];          //!< Output staging buffer.
+        uint8_t window[2 * WINDOW_SIZE];    //!< The history and lookahead.
+        uint16_t head[HASH_SIZE];           //!< Most recent position + 1 for each hash; 0 if none.
+        uint16_t previous[WINDOW_SIZE];     //!< Previous position + 1 with the same hash, indexed by position.
+    };
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <pgmspace.h>
+
+namespace grmcdorman
+{
+    /**
+     * @brief The layout of an `HtmlTemplate`.
+     *
+     * The template text is divided into segments of static text, each
+     * followed by a field whose value is supplied when the template is written.
+     */
+    struct HtmlTemplateLayout
+    {
+        static constexpr size_t MAX_SEGMENTS = 16;      //!< The maximum number of segments; one more than the maximum number of fields.
+        static constexpr char MAX_FIELD = '\x08';       //!< The highest field code.
+
+        uint8_t segment_count;                          //!< The number of segments.
+        uint16_t segment_end[MAX_SEGMENTS];             //!< For each segment, the offset of its end in the text.
+        uint8_t field[MAX_SEGMENTS];                    //!< For each segment, the field that follows it; 0 if none.
+    };
+
+    /**
+     * @brief Static HTML with fields, prepared at compile time.
+     *
+     * Templates are built by `make_html_template` from a string literal in which
+     * the characters `\x01` through `\x08` mark fields. The fields are removed from
+     * the text and recorded in the layout, so that writing the template is a few
+     * copies from PROGMEM, with no scanning at run time.
+     *
+     * Declare templates as `static constexpr` and `PROGMEM`. Escapes are processed
+     * before string literals are concatenated, so fields are best written as separate
+     * literals, e.g. `"id=\"" "\x01" "\""`.
+     *
+     * @tparam N    The size of the source string literal.
+     */
+    template<size_t N>
+    struct HtmlTemplate
+    {
+        HtmlTemplateLayout layout;      //!< The segments and fields.
+        char text[N];                   //!< The static text, without fields; not null terminated.
+    };
+
+    //!< The value for a field in an `HtmlTemplate`.
+    struct HtmlTemplateField
+    {
+        PGM_P text;         //!< The value, in PROGMEM.
+        size_t length;      //!< The length of the value.
+    };
+
+    /**
+     * @brief Build an HTML template.
+     *
+     * A source with more than `HtmlTemplateLayout::MAX_SEGMENTS - 1` fields is
+     * not a constant expression, and will not compile when used as a `constexpr` initializer.
+     *
+     * @tparam N        The size of the source; inferred from the arguments.
+     * @param source    The template text, with field codes.
+     * @return The template.
+     */
+    template<size_t N>
+    constexpr HtmlTemplate<N> make_html_template(const char (&source)[N])
+    {
+        HtmlTemplate<N> result{};
+        uint16_t length = 0;
+        for (size_t i = 0; i + 1 < N; ++i)
+        {
+            char ch = source[i];
+            if (ch >= '\x01' && ch <= HtmlTemplateLayout::MAX_FIELD)
+            {
+                result.layout.segment_end[result.layout.segment_count] = length;
+                result.layout.field[result.layout.segment_count] = static_cast<uint8_t>(ch);
+                ++result.layout.segment_count;
+            }
+            else
+            {
+                result.text[length++] = ch;
+            }
+        }
+        result.layout.segment_end[result.layout.segment_count] = length;
+        result.layout.field[result.layout.segment_count] = 0;
+        ++result.layout.segment_count;
+        return result;
+    }
+}
@@ -0,0 +1,238 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <pgmspace.h>
+#include <WString.h>
+
+#include "grmcdorman/HtmlTemplate.h"
+
+namespace grmcdorman
+{
+    /**
+     * @brief A resumable writer for HTML fragments.
+     *
+     * The writer copies text directly into a caller-supplied buffer, typically
+     * the buffer for a chunked response. No heap allocations are performed.
+     *
+     * Fragments that do not fit in the buffer are resumed on the next chunk by
+     * writing the fragment again from the beginning with a `skip` count equal to
+     * the number of bytes already sent; the writer discards those bytes and continues
+     * where the previous chunk left off. This requires the fragment to be the same
+     * on each call, which holds for all setting HTML.
+     *
+     * Once the buffer is full, further output is discarded and `overflowed()` returns `true`.
+     */
+    class HtmlWriter
+    {
+    public:
+        /**
+         * @brief Construct a new HTML writer.
+         *
+         * @param buffer    The output buffer.
+         * @param capacity  The available capacity of `buffer`.
+         * @param skip      The number of bytes of the fragment already sent in a previous chunk.
+         */
+        HtmlWriter(uint8_t *buffer, size_t capacity, size_t skip = 0):
+            buffer(buffer), capacity(capacity), skip(skip), used(0), overflow(false)
+        {
+        }
+
+        /**
+         * @brief Write a single character.
+         *
+         * @param ch    Character to write.
+         */
+        void write(char ch)
+        {
+            write(&ch, 1);
+        }
+
+        /**
+         * @brief Write text from RAM.
+         *
+         * @param text      Text to write. Need not be null terminated.
+         * @param length    The number of characters to write.
+         */
+        void write(const char *text, size_t length);
+
+        /**
+         * @brief Write a string.
+         *
+         * @param text      String to write.
+         */
+        void write(const String &text)
+        {
+            write(text.c_str(), text.length());
+        }
+
+        /**
+         * @brief Write a PROGMEM string.
+         *
+         * @param text      String to write.
+         */
+        void write(const __FlashStringHelper *text)
+        {
+            write_P(reinterpret_cast<PGM_P>(text), strlen_P(reinterpret_cast<PGM_P>(text)));
+        }
+
+        /**
+         * @brief Write text from PROGMEM.
+         *
+         * @param text      Text to write.
+         * @param length    The number of characters to write.
+         */
+        void write_P(PGM_P text, size_t length);
+
+        /**
+         * @brief Write a PROGMEM character array.
+         *
+         * The trailing null is not written.
+         *
+         * @tparam N        The array size; inferred from the arguments.
+         * @param text      Text to write.
+         */
+        template<size_t N>
+        void write_P(const char (&text)[N])
+        {
+            write_P(text, N - 1);
+        }
+
+        /**
+         * @brief Write an HTML template.
+         *
+         * @tparam N        The template size; inferred from the arguments.
+         * @param html      The template, in PROGMEM.
+         * @param fields    The field values; field code 1 is `fields[0]`.
+         */
+        template<size_t N>
+        void write_template(const HtmlTemplate<N> &html, const HtmlTemplateField *fields)
+        {
+            write_template_P(&html.layout, html.text, fields);
+        }
+
+        /**
+         * @brief Write an HTML template, given its layout and text.
+         *
+         * @param layout    The template layout, in PROGMEM.
+         * @param text      The template text, in PROGMEM.
+         * @param fields    The field values; field code 1 is `fields[0]`.
+         */
+        void write_template_P(const HtmlTemplateLayout *layout, PGM_P text, const HtmlTemplateField *fields);
+
+        /**
+         * @brief Write an unsigned number in decimal.
+         *
+         * @param value     Value to write.
+         */
+        void write_unsigned(uint32_t value);
+
+        /**
+         * @brief Write a signed number in decimal.
+         *
+         * @param value     Value to write.
+         */
+        void write_signed(int32_t value);
+
+        /**
+         * @brief Write text, escaped for the inside of a JSON string.
+         *
+         * The surrounding quotes are not written.
+         *
+         * @param text      Raw text.
+         * @param length    The number of characters in `text`.
+         */
+        void write_json_escaped(const char *text, size_t length);
+
+        /**
+         * @brief Write a string, escaped for the inside of a JSON string.
+         *
+         * The surrounding quotes are not written.
+         *
+         * @param text      Raw text.
+         */
+        void write_json_escaped(const String &text)
+        {
+            write_json_escaped(text.c_str(), text.length());
+        }
+
+        /**
+         * @brief Write PROGMEM text, escaped for the inside of a JSON string.
+         *
+         * The surrounding quotes are not written.
+         *
+         * @param text      Raw text.
+         * @param length    The number of characters in `text`.
+         */
+        void write_json_escaped_P(PGM_P text, size_t length);
+
+        /**
+         * @brief Write a PROGMEM string, escaped for the inside of a JSON string.
+         *
+         * The surrounding quotes are not written.
+         *
+         * @param text      Raw text.
+         */
+        void write_json_escaped(const __FlashStringHelper *text)
+        {
+            write_json_escaped_P(reinterpret_cast<PGM_P>(text), strlen_P(reinterpret_cast<PGM_P>(text)));
+        }
+
+        /**
+         * @brief Get the number of bytes placed in the buffer.
+         *
+         * @return Bytes placed in the buffer by this writer.
+         */
+        size_t size() const
+        {
+            return used;
+        }
+
+        /**
+         * @brief Whether output was discarded because the buffer was full.
+         *
+         * @return `true` if the fragment must be resumed in another chunk.
+         */
+        bool overflowed() const
+        {
+            return overflow;
+        }
+
+    private:
+        /**
+         * @brief Account for a write request.
+         *
+         * This consumes any remaining `skip` count and limits the length to
+         * the buffer's remaining capacity.
+         *
+         * @param length[in,out]    On call, the requested length. On return, the length to copy.
+         * @return The offset into the source text at which to start copying.
+         */
+        size_t accept(size_t &length);
+
+        /**
+         * @brief Determine whether a character must be escaped in a JSON string.
+         *
+         * @param ch        Character to check.
+         * @return `true` if `write_json_escape` must be used for the character.
+         */
+        static bool needs_json_escape(char ch)
+        {
+            return ch == '"' || ch == '\\' || static_cast<uint8_t>(ch) < 0x20;
+        }
+
+        /**
+         * @brief Write the JSON escape sequence for a character.
+         *
+         * @param ch        Character to write.
+         */
+        void write_json_escape(char ch);
+
+        uint8_t *buffer;        //!< The output buffer.
+        size_t capacity;        //!< The capacity of the output buffer.
+        size_t skip;            //!< Bytes still to be discarded before output starts.
+        size_t used;            //!< Bytes written to the output buffer.
+        bool overflow;          //!< Set when output has been discarded.
+    };
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <pgmspace.h>
+
+namespace grmcdorman
+{
+    /**
+     * @brief 32-bit FNV-1a hashing, for looking up names and for entity tags.
+     *
+     * Hashes can be built incrementally; start with `basis` and pass the result
+     * of each call to the next.
+     */
+    namespace name_hash
+    {
+        constexpr uint32_t basis = 0x811c9dc5;      //!< The FNV-1a initial hash value.
+        constexpr uint32_t prime = 0x01000193;      //!< The FNV-1a multiplier.
+
+        /**
+         * @brief Continue a hash with a single character.
+         *
+         * @param hash      The hash so far.
+         * @param ch        Character to include.
+         * @return The updated hash.
+         */
+        constexpr uint32_t update(uint32_t hash, char ch)
+        {
+            return (hash ^ static_cast<uint8_t>(ch)) * prime;
+        }
+
+        /**
+         * @brief Hash a block of data.
+         *
+         * This can be used at compile time.
+         *
+         * @param data      Data to hash.
+         * @param length    Length of the data.
+         * @return The hash.
+         */
+        constexpr uint32_t hash(const uint8_t *data, size_t length)
+        {
+            uint32_t hash = basis;
+            for (size_t i = 0; i < length; ++i)
+            {
+                hash = update(hash, static_cast<char>(data[i]));
+            }
+            return hash;
+        }
+
+        /**
+         * @brief Hash text in RAM.
+         *
+         * @param text      Text to hash. Need not be null terminated.
+         * @param length    The number of characters to hash.
+         * @return The hash.
+         */
+        inline uint32_t hash(const char *text, size_t length)
+        {
+            return hash(reinterpret_cast<const uint8_t *>(text), length);
+        }
+
+        /**
+         * @brief Continue a hash with a null-terminated PROGMEM string.
+         *
+         * @param hash      The hash so far.
+         * @param text      Text to include.
+         * @return The updated hash.
+         */
+        inline uint32_t update_P(uint32_t hash, PGM_P text)
+        {
+            for (char ch = pgm_read_byte(text); ch != '\0'; ch = pgm_read_byte(++text))
+            {
+                hash = update(hash, ch);
+            }
+            return hash;
+        }
+    }
+}
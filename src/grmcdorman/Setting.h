@@ -6,8 +6,69 @@
 #include <pgmspace.h>
 #include <WString.h>
 
+#include "grmcdorman/HtmlWriter.h"
+
 namespace grmcdorman
 {
+    //!< The type of a setting's value in storage.
+    enum class StorageType: uint8_t
+    {
+        NONE,       //!< Not stored.
+        STRING,     //!< Characters, without a terminating null.
+        SIGNED,     //!< A signed integer, little-endian.
+        UNSIGNED,   //!< An unsigned integer, little-endian.
+        FLOAT,      //!< An IEEE 754 single-precision number, little-endian.
+        BOOLEAN     //!< A single byte, 0 or 1.
+    };
+
+    /**
+     * @brief The storage type for a setting value type.
+     *
+     * Value types without a specialization are not stored by `GenericSetting`.
+     *
+     * @tparam T    The value type.
+     */
+    template<typename T>
+    struct StorageTraits
+    {
+        static constexpr StorageType type = StorageType::NONE;     //!< The storage type.
+    };
+
+    //!< Signed integers are stored as `SIGNED`.
+    template<>
+    struct StorageTraits<int32_t>
+    {
+        static constexpr StorageType type = StorageType::SIGNED;   //!< The storage type.
+    };
+
+    //!< Unsigned integers are stored as `UNSIGNED`.
+    template<>
+    struct StorageTraits<uint32_t>
+    {
+        static constexpr StorageType type = StorageType::UNSIGNED; //!< The storage type.
+    };
+
+    //!< Unsigned integers are stored as `UNSIGNED`.
+    template<>
+    struct StorageTraits<uint16_t>
+    {
+        static constexpr StorageType type = StorageType::UNSIGNED; //!< The storage type.
+    };
+
+    //!< Floats are stored as `FLOAT`.
+    template<>
+    struct StorageTraits<float>
+    {
+        static constexpr StorageType type = StorageType::FLOAT;    //!< The storage type.
+    };
+
+    //!< Booleans are stored as `BOOLEAN`.
+    template<>
+    struct StorageTraits<bool>
+    {
+        static constexpr StorageType type = StorageType::BOOLEAN;  //!< The storage type.
+    };
+
     /**
      * @brief The generic settings interface.
      *
@@ -26,13 +87,33 @@ namespace grmcdorman
         SettingInterface(const __FlashStringHelper *description, const __FlashStringHelper *setting_name);
     public:
         typedef std::vector<SettingInterface *> settings_list_t;    //!< The container for a list of settings.
+
+        //!< Settings created at run time can be destroyed through this interface.
+        virtual ~SettingInterface()
+        {
+        }
+
         /**
-         * @brief Stream the HTML fragment for the setting.
+         * @brief Write the HTML fragment for the setting.
+         *
+         * The fragment must be identical every time it is written for the same
+         * state; a fragment that does not fit in one chunk is resumed by writing
+         * it again (see `HtmlWriter`).
          *
+         * @param writer            The output writer.
          * @param container_name    The unique container name (system -wide). Used to generate a unique field identifier.
-         * @return HTML for the setting.
          */
-        virtual String get_html(const String &container_name) const = 0;
+        virtual void write_html(HtmlWriter &writer, const __FlashStringHelper *container_name) const = 0;
+        /**
+         * @brief Write the schema description of the setting.
+         *
+         * This is a compact JSON object from which the browser constructs the
+         * setting's controls; see `write_schema_start`. As with `write_html`,
+         * the output must be identical every time it is written.
+         *
+         * @param writer            The output writer.
+         */
+        virtual void write_schema(HtmlWriter &writer) const = 0;
         /**
          * @brief Set the value from a string.
          *
@@ -88,16 +169,16 @@ namespace grmcdorman
             return FPSTR(description);
         }
         /**
-         * @brief Get the label HTML fragment for this setting.
+         * @brief Write the label HTML fragment for this setting.
          *
          * The label contains the description text. It is formatted
          * with a `FOR` field referring to the input or selection element
-         * returned by the `html` method.
+         * written by the `write_html` method.
          *
-         * @param input_name    The unique (system-wide) name for the input element.
-         * @return HTML label.
+         * @param writer            The output writer.
+         * @param container_name    The unique container name (system -wide). Used to generate a unique field identifier.
          */
-        String get_html_label(const String &input_name) const;
+        void write_html_label(HtmlWriter &writer, const __FlashStringHelper *container_name) const;
         /**
          * @brief Get the value as a string.
          *
@@ -109,6 +190,76 @@ namespace grmcdorman
          */
         virtual String as_string() const = 0;
 
+        /**
+         * @brief Write the value as JSON.
+         *
+         * By default this is `as_string()` as a JSON string; settings with numeric
+         * or boolean values write the native JSON type. As with `write_html`, the output must be
+         * identical every time it is written, until `prepare_to_send` is next called.
+         *
+         * @param writer            The output writer.
+         */
+        virtual void write_json_value(HtmlWriter &writer) const;
+
+        /**
+         * @brief Write the setting as a JSON object for the UI.
+         *
+         * This is an object with the `name` and `value` fields; the value
+         * is written by `write_json_value`.
+         *
+         * @param writer            The output writer.
+         */
+        void write_json(HtmlWriter &writer) const;
+
+        /**
+         * @brief Get the setting's version.
+         *
+         * Every change to any setting's value increments a global version; this is
+         * the global version at the last change to this setting, or 0 if it has not
+         * changed since construction.
+         *
+         * @return Setting version.
+         */
+        uint32_t get_version() const
+        {
+            return version;
+        }
+
+        /**
+         * @brief Get the global version.
+         *
+         * Settings with a version greater than this value have changed since it was retrieved.
+         *
+         * @return The current global version.
+         */
+        static uint32_t get_current_version()
+        {
+            return current_version;
+        }
+
+        /**
+         * @brief Whether the value changes independently of the UI.
+         *
+         * Such values are sampled periodically and pushed to the UI through the
+         * events channel. By default, this returns `false`.
+         *
+         * @return `true` if the value is pushed to the UI when it changes.
+         */
+        virtual bool is_dynamic() const
+        {
+            return false;
+        }
+
+        /**
+         * @brief Prepare the value before it is sent to the UI.
+         *
+         * This is called once before the value is written with `write_json_value`,
+         * allowing settings with dynamic values to update them. By default, it does nothing.
+         */
+        virtual void prepare_to_send() const
+        {
+        }
+
         /**
          * @brief Whether to send the value to the UI on request.
          *
@@ -136,70 +287,121 @@ namespace grmcdorman
             return true;
         }
 
-    protected:
         /**
-         * @brief Output an INPUT field and a LABEL field.
+         * @brief Get the value in its stored form.
          *
-         * This constructs a full INPUT field of the given type. The
-         * output HTML includes the constructed input field, followed
-         * by the label for the field.
+         * The stored form is compact binary, used by `WebSettings::save_settings`.
+         * By default, settings are not stored.
          *
-         * @note Will produce syntatically correct but unusable output if
-         * the setting's name is blank.
+         * @param[out] data     Set to the stored value; valid until the value next changes.
+         * @param[out] length   Set to the length of the stored value.
+         * @return The storage type; `StorageType::NONE` if the value is not stored.
+         */
+        virtual StorageType get_stored(const void *&data, size_t &length) const
+        {
+            return StorageType::NONE;
+        }
+
+        /**
+         * @brief Set the value from its stored form.
          *
-         * @param type              The INPUT type, e.g. NUMBER.
-         * @param container_name    The unique container name (system -wide). Used to generate a unique field identifier.
-         * @param value             The initial value.
-         * @param extra             Additional fields. `nullptr` if no fields are to be provided.
-         * @return Constructed INPUT field.
+         * @param type      The storage type.
+         * @param data      The stored value.
+         * @param length    The length of the stored value.
+         * @return `true` if the value was set; `false` if the type or length is not that of the setting.
          */
-        String get_make_input(const __FlashStringHelper *type, const String &container_name, const String &value, const __FlashStringHelper * extra) const;
+        virtual bool set_from_stored(StorageType type, const void *data, size_t length)
+        {
+            return false;
+        }
+
+    protected:
         /**
-         * @brief Output the HTML for an arbitrary input and label.
+         * @brief Output HTML from a template.
          *
-         * This outputs the text in `setting_html`, verbatim, followed by a LABEL field.
-         *
-         * @note Will produce syntatically correct but unusable output if
-         * the setting's name is blank.
+         * The template holds the setting's static markup, assembled at compile time; see
+         * `HtmlTemplate`. The fields are:
+         *  * `\x01`: the container name.
+         *  * `\x02`: the setting name.
+         *  * `\x03`: the description.
          *
+         * @tparam N                The template size; inferred from the arguments.
+         * @param writer            The output writer.
+         * @param html              The template, in PROGMEM.
          * @param container_name    The unique container name (system -wide). Used to generate a unique field identifier.
-         * @param setting_html      The setting HTML; for example a SELECT list.
-         * @return Constructed HTML.
          */
-        String get_make_html(const String &container_name, const String &setting_html) const;
+        template<size_t N>
+        void write_html_template(HtmlWriter &writer, const HtmlTemplate<N> &html, const __FlashStringHelper *container_name) const
+        {
+            const HtmlTemplateField fields[] = {
+                container_field(container_name),
+                HtmlTemplateField{ reinterpret_cast<PGM_P>(setting_name), name_length },
+                HtmlTemplateField{ reinterpret_cast<PGM_P>(description), description_length }
+            };
+            writer.write_template(html, fields);
+        }
         /**
-         * @brief Stream out the unique control ID.
+         * @brief Output the unique control ID.
          *
-         * This streams out the container name, a '$', and the setting name. It
+         * This writes the container name, a '$', and the setting name. It
          * is used in other context where the control ID is required.
          *
          * @note Will produce syntatically correct but unusable output if
          * the setting's name is blank.
          *
+         * @param writer            The output writer.
          * @param container_name    The unique container name (system -wide). Used to generate a unique field identifier.
-         * @return HTML text.
          */
-        String get_unique_id(const String &container_name) const;
+        void write_unique_id(HtmlWriter &writer, const __FlashStringHelper *container_name) const;
         /**
-         * @brief Return `id=` and `name=` attributes.
+         * @brief Output `id=` and `name=` attributes.
          *
          * @note Will produce syntatically correct but unusable output if
          * the setting's name is blank.
          *
+         * @param writer            The output writer.
          * @param container_name    The unique container name (system -wide). Used to generate a unique field identifier.
-         * @return The two fields.
          */
-        String get_id_name_fields(const String &container_name) const;
+        void write_id_name_fields(HtmlWriter &writer, const __FlashStringHelper *container_name) const;
+        /**
+         * @brief Output the start of the schema object.
+         *
+         * This writes the opening brace and the common fields: `t`, the control
+         * type; `n`, the setting name; `d`, the description; and, if `send_to_ui()`
+         * is `false`, `"u":0`. The caller adds any other fields and the closing brace.
+         *
+         * @param writer            The output writer.
+         * @param type              The control type, e.g. NUMBER.
+         */
+        void write_schema_start(HtmlWriter &writer, const __FlashStringHelper *type) const;
         /**
-         * @brief Escape a value appropriately for an input value field.
+         * @brief Record a change to the value.
          *
-         * @param value     Raw value.
-         * @return Escaped value.
+         * This advances the global version, and sets the setting's version to it.
+         * Setting classes call this whenever the value changes.
          */
-        String escape_value(const String &value) const;
+        void mark_changed()
+        {
+            version = ++current_version;
+        }
     private:
+        /**
+         * @brief Make the template field value for a container name.
+         *
+         * A panel writes all of its settings in turn, so the length of the last
+         * container name is kept, and only measured when the container changes.
+         *
+         * @param container_name    The container name, in PROGMEM.
+         * @return The field value.
+         */
+        static HtmlTemplateField container_field(const __FlashStringHelper *container_name);
+
         const __FlashStringHelper *description;   //!< The description from the constructor.
         const __FlashStringHelper *setting_name;  //!< The name from the constructor.
+        uint16_t description_length;              //!< The length of the description, which is limited to 65535 characters; measured once, in the constructor.
+        uint16_t name_length;                     //!< The length of the name; measured once, in the constructor.
+        uint32_t version;                         //!< The global version at the last change; 0 if never changed.
+        static uint32_t current_version;          //!< The global version; incremented on every change to any setting.
     };
 
     /**
@@ -243,11 +445,17 @@ namespace grmcdorman
         /**
          * @brief Set the value.
          *
+         * If the value is different, the setting's version is updated.
+         *
          * @param new_value The new value.
          */
         void set(const T &new_value)
         {
-            value = new_value;
+            if (!(value == new_value))
+            {
+                value = new_value;
+                mark_changed();
+            }
         }
 
         /**
@@ -271,7 +479,51 @@ namespace grmcdorman
          */
         void set_default() override
         {
-            value = T();
+            set(T());
+        }
+
+        /**
+         * @brief Get the value in its stored form.
+         *
+         * Types with a `StorageTraits` specialization are stored as their native
+         * representation; others are not stored.
+         *
+         * @param[out] data     Set to the stored value; valid until the value next changes.
+         * @param[out] length   Set to the length of the stored value.
+         * @return The storage type; `StorageType::NONE` if the value is not stored.
+         */
+        StorageType get_stored(const void *&data, size_t &length) const override
+        {
+            data = &value;
+            length = sizeof(value);
+            return StorageTraits<T>::type;
+        }
+
+        /**
+         * @brief Set the value from its stored form.
+         *
+         * @param type      The storage type.
+         * @param data      The stored value.
+         * @param length    The length of the stored value.
+         * @return `true` if the value was set; `false` if the type or length is not that of the setting.
+         */
+        bool set_from_stored(StorageType type, const void *data, size_t length) override
+        {
+            if constexpr (StorageTraits<T>::type == StorageType::NONE)
+            {
+                return false;
+            }
+            else
+            {
+                if (type != StorageTraits<T>::type || length != sizeof(T))
+                {
+                    return false;
+                }
+                T new_value;
+                memcpy(&new_value, data, sizeof(T));
+                set(new_value);
+                return true;
+            }
         }
     protected:
         T value;    //!< The contained value.
@@ -304,15 +556,23 @@ namespace grmcdorman
         }
 
         /**
-         * @brief Return the HTML.
+         * @brief Write the HTML.
          *
          * In this case, it is simply the note value. No interpolation
          * or other processing is performed on the HTML.
          *
-         * @param container_name    The unique container name (system -wide). Used to generate a unique field identifier.
-         * @return HTML text.
+         * @param writer            The output writer.
+         * @param container_name    The unique container name (system -wide). Not used.
+         */
+        void write_html(HtmlWriter &writer, const __FlashStringHelper *container_name) const override;
+        /**
+         * @brief Write the schema description of the setting.
+         *
+         * For this setting, the type is `note` and the note text is sent as `d`.
+         *
+         * @param writer            The output writer.
          */
-        String get_html(const String &container_name) const override;
+        void write_schema(HtmlWriter &writer) const override;
 
         /**
          * @brief Set the note value.
@@ -359,14 +619,30 @@ namespace grmcdorman
         {
         }
         /**
-         * @brief Return the HTML for the setting.
+         * @brief Write the HTML for the setting.
          *
          * For a string setting, this will be of the form `<INPUT TYPE="TEXT">`.
          *
+         * @param writer            The output writer.
          * @param container_name    The unique container name (system -wide). Used to generate a unique field identifier.
-         * @return HTML text..
          */
-        String get_html(const String &container_name) const override;
+        void write_html(HtmlWriter &writer, const __FlashStringHelper *container_name) const override;
+        /**
+         * @brief Write the schema description of the setting.
+         *
+         * For this setting, the type is `text`.
+         *
+         * @param writer            The output writer.
+         */
+        void write_schema(HtmlWriter &writer) const override;
+        /**
+         * @brief Write the value as JSON.
+         *
+         * For a string setting, this is the value as a JSON string.
+         *
+         * @param writer            The output writer.
+         */
+        void write_json_value(HtmlWriter &writer) const override;
         /**
          * @brief Set the value from a string.
          *
@@ -379,6 +655,30 @@ namespace grmcdorman
         {
             set(new_value);
         }
+        /**
+         * @brief Get the value in its stored form.
+         *
+         * For a string setting, this is the characters of the string.
+         *
+         * @param[out] data     Set to the stored value; valid until the value next changes.
+         * @param[out] length   Set to the length of the stored value.
+         * @return `StorageType::STRING`.
+         */
+        StorageType get_stored(const void *&data, size_t &length) const override
+        {
+            data = get().c_str();
+            length = get().length();
+            return StorageType::STRING;
+        }
+        /**
+         * @brief Set the value from its stored form.
+         *
+         * @param type      The storage type.
+         * @param data      The stored value.
+         * @param length    The length of the stored value.
+         * @return `true` if the value was set; `false` if the type is not `StorageType::STRING`.
+         */
+        bool set_from_stored(StorageType type, const void *data, size_t length) override;
     };
 
     /**
@@ -420,7 +720,23 @@ namespace grmcdorman
         {
             return false;
         }
-        String get_html(const String &container_name) const override;
+        /**
+         * @brief Write the HTML for the setting.
+         *
+         * For a password setting, this will be a checkbox enabling a `<INPUT TYPE="PASSWORD">`.
+         *
+         * @param writer            The output writer.
+         * @param container_name    The unique container name (system -wide). Used to generate a unique field identifier.
+         */
+        void write_html(HtmlWriter &writer, const __FlashStringHelper *container_name) const override;
+        /**
+         * @brief Write the schema description of the setting.
+         *
+         * For this setting, the type is `password`.
+         *
+         * @param writer            The output writer.
+         */
+        void write_schema(HtmlWriter &writer) const override;
     };
 
     /**
@@ -443,14 +759,30 @@ namespace grmcdorman
         {
         }
         /**
-         * @brief Stream the HTML for the setting.
+         * @brief Write the HTML for the setting.
          *
          * For a signed integer, this will be a simple input of the form `<INPUT TYPE="NUMBER">`.
          *
+         * @param writer            The output writer.
          * @param container_name    The unique container name (system -wide). Used to generate a unique field identifier.
-         * @return HTML text.
          */
-        String get_html(const String &container_name) const override;
+        void write_html(HtmlWriter &writer, const __FlashStringHelper *container_name) const override;
+        /**
+         * @brief Write the schema description of the setting.
+         *
+         * For this setting, the type is `number`.
+         *
+         * @param writer            The output writer.
+         */
+        void write_schema(HtmlWriter &writer) const override;
+        /**
+         * @brief Write the value as JSON.
+         *
+         * For a signed integer, this is a JSON number.
+         *
+         * @param writer            The output writer.
+         */
+        void write_json_value(HtmlWriter &writer) const override;
         /**
          * @brief Set the value from a string.
          *
@@ -482,14 +814,30 @@ namespace grmcdorman
         {
         }
         /**
-         * @brief Stream the HTML for the setting.
+         * @brief Write the HTML for the setting.
          *
          * For an unsigned integer, this will be a simple input of the form `<INPUT TYPE="NUMBER" MAX="0">`.
          *
+         * @param writer            The output writer.
          * @param container_name    The unique container name (system -wide). Used to generate a unique field identifier.
-         * @return HTML text.
          */
-        String get_html(const String &container_name) const override;
+        void write_html(HtmlWriter &writer, const __FlashStringHelper *container_name) const override;
+        /**
+         * @brief Write the schema description of the setting.
+         *
+         * For this setting, the type is `number`, with `min` set to 0.
+         *
+         * @param writer            The output writer.
+         */
+        void write_schema(HtmlWriter &writer) const override;
+        /**
+         * @brief Write the value as JSON.
+         *
+         * For an unsigned integer, this is a JSON number.
+         *
+         * @param writer            The output writer.
+         */
+        void write_json_value(HtmlWriter &writer) const override;
         /**
          * @brief Set the value from a string.
          *
@@ -523,14 +871,30 @@ namespace grmcdorman
         {
         }
         /**
-         * @brief Stream the HTML for the setting.
+         * @brief Write the HTML for the setting.
          *
          * For a floating point, this will be a simple input of the form `<INPUT TYPE="NUMBER" STEP="0.1">`.
          *
+         * @param writer            The output writer.
          * @param container_name    The unique container name (system -wide). Used to generate a unique field identifier.
-         * @return HTML text.
          */
-        String get_html(const String &container_name) const override;
+        void write_html(HtmlWriter &writer, const __FlashStringHelper *container_name) const override;
+        /**
+         * @brief Write the schema description of the setting.
+         *
+         * For this setting, the type is `number`, with `step` set to 0.1.
+         *
+         * @param writer            The output writer.
+         */
+        void write_schema(HtmlWriter &writer) const override;
+        /**
+         * @brief Write the value as JSON.
+         *
+         * For a floating point, this is a JSON number with two decimal digits, or `null` if the value is not finite.
+         *
+         * @param writer            The output writer.
+         */
+        void write_json_value(HtmlWriter &writer) const override;
         /**
          * @brief Set the value from a string.
          *
@@ -566,7 +930,7 @@ namespace grmcdorman
         }
 
         /**
-         * @brief Stream the exclusive-setting HTML.
+         * @brief Write the exclusive-setting HTML.
          *
          * This constructs a `SELECT` HTML with the option list.
          *
@@ -577,10 +941,26 @@ namespace grmcdorman
          *
          * @note Option names are not escaped; it is possible to include HTML
          * in the name.
+         * @param writer            The output writer.
          * @param container_name    The unique container name (system -wide). Used to generate a unique field identifier.
-         * @return The constructed HTML.
          */
-        String get_html(const String &container_name) const override; // dropdown or radio buttons
+        void write_html(HtmlWriter &writer, const __FlashStringHelper *container_name) const override; // dropdown or radio buttons
+        /**
+         * @brief Write the schema description of the setting.
+         *
+         * For this setting, the type is `select`, and `o` holds the option names.
+         *
+         * @param writer            The output writer.
+         */
+        void write_schema(HtmlWriter &writer) const override;
+        /**
+         * @brief Write the value as JSON.
+         *
+         * For an exclusive option, this is the option name as a JSON string.
+         *
+         * @param writer            The output writer.
+         */
+        void write_json_value(HtmlWriter &writer) const override;
         /**
          * @brief Set the option from a string value.
          *
@@ -620,14 +1000,30 @@ namespace grmcdorman
         {
         }
         /**
-         * @brief Stream the toggle HTML.
+         * @brief Write the toggle HTML.
          *
          * For a toggle, this will be of the form `<INPUT TYPE='CHECKBOX'>`.
          *
+         * @param writer            The output writer.
          * @param container_name    The unique container name (system -wide). Used to generate a unique field identifier.
-         * @return The constructed HTML.
          */
-        String get_html(const String &container_name) const override;
+        void write_html(HtmlWriter &writer, const __FlashStringHelper *container_name) const override;
+        /**
+         * @brief Write the schema description of the setting.
+         *
+         * For this setting, the type is `checkbox`.
+         *
+         * @param writer            The output writer.
+         */
+        void write_schema(HtmlWriter &writer) const override;
+        /**
+         * @brief Write the value as JSON.
+         *
+         * For a toggle, this is `true` or `false`.
+         *
+         * @param writer            The output writer.
+         */
+        void write_json_value(HtmlWriter &writer) const override;
         /**
          * @brief Set the value from a string.
          *
@@ -684,6 +1080,9 @@ namespace grmcdorman
      * fields as well as the other fields.
      *
      * The value will also be requested on initial page load, and when the user clicks "Reset Form".
+     *
+     * While the browser is connected to the server's events channel, changed values are pushed
+     * instead, and the periodic update is not used.
      */
     class InfoSettingHtml: public StringSetting
     {
@@ -695,10 +1094,18 @@ namespace grmcdorman
          * @param setting_name      The unique setting name. This must be unique for the container. It can be empty for notes.
          */
         InfoSettingHtml(const __FlashStringHelper *description, const __FlashStringHelper *setting_name):
-            StringSetting(description, setting_name), request_callback(nullptr)
+            StringSetting(description, setting_name), request_callback(nullptr), max_age(0), last_refresh(0),
+            refreshed(false), background_refresh(false)
         {
         }
 
+        /**
+         * @brief Destroy the Info Setting Html object.
+         *
+         * If background refresh is enabled, the setting is no longer refreshed.
+         */
+        ~InfoSettingHtml();
+
         /**
          * @brief Set the request callback.
          *
@@ -712,17 +1119,83 @@ namespace grmcdorman
         void set_request_callback(const std::function<void(const InfoSettingHtml &)>& callback)
         {
             request_callback = callback;
+            refreshed = false;
+        }
+
+        /**
+         * @brief Set the maximum age of the value.
+         *
+         * The request callback is only invoked if the value was last refreshed at least
+         * this long ago; otherwise the previous value is sent. This bounds the cost of the
+         * callback regardless of the number of requests. The default is 0: the callback
+         * is invoked for every request.
+         *
+         * @param max_age_ms    Maximum age, in milliseconds.
+         */
+        void set_max_age(uint32_t max_age_ms)
+        {
+            max_age = max_age_ms;
         }
+
+        /**
+         * @brief Enable or disable background refresh.
+         *
+         * When enabled, the request callback is never invoked for requests; instead, it is
+         * invoked from `WebSettings::loop` whenever the value is older than the maximum age
+         * (see `set_max_age`). This keeps slow callbacks, such as sensor reads, out of request
+         * handling. With a maximum age of 0 the callback is invoked on every `loop`.
+         *
+         * Only the info settings with background refresh enabled are visited by `loop`, so the
+         * number of other settings does not add to its cost.
+         *
+         * @param enable    `true` to refresh the value in the background.
+         */
+        void set_background_refresh(bool enable);
+
         /**
-         * @brief Stream the info HTML.
+         * @brief Refresh the info settings that have background refresh enabled.
+         *
+         * Each value is refreshed if it is older than its maximum age. This is called
+         * from `WebSettings::loop`.
+         */
+        static void refresh_in_background();
+        /**
+         * @brief Write the info HTML.
          *
          * For an info setting, this will be a SPAN containing the value, and
          * a LABEL field for the SPAN.
          *
+         * @param writer            The output writer.
          * @param container_name    The unique container name (system -wide). Used to generate a unique field identifier.
-         * @return The constructed HTML.
          */
-        String get_html(const String &container_name) const override;
+        void write_html(HtmlWriter &writer, const __FlashStringHelper *container_name) const override;
+        /**
+         * @brief Write the schema description of the setting.
+         *
+         * For this setting, the type is `info`.
+         *
+         * @param writer            The output writer.
+         */
+        void write_schema(HtmlWriter &writer) const override;
+        /**
+         * @brief Prepare the value before it is sent to the UI.
+         *
+         * This invokes the request callback, if any, unless the value is
+         * still fresh or is refreshed in the background.
+         */
+        void prepare_to_send() const override;
+
+        /**
+         * @brief Whether the value changes independently of the UI.
+         *
+         * For info settings, this always returns `true`.
+         *
+         * @return `true`: the value is pushed to the UI when it changes.
+         */
+        bool is_dynamic() const override
+        {
+            return true;
+        }
         /**
          * @brief Set the value from an HTML Post string.
          *
@@ -760,6 +1233,30 @@ namespace grmcdorman
             return false;
         }
    private:
-        std::function<void(const InfoSettingHtml &)> request_callback;
+        /**
+         * @brief Whether the value is older than the maximum age, or has never been refreshed.
+         *
+         * @return `true` if the value must be refreshed.
+         */
+        bool is_stale() const;
+
+        /**
+         * @brief Invoke the request callback, and record the time.
+         */
+        void refresh() const;
+
+        /**
+         * @brief Get the info settings that have background refresh enabled.
+         *
+         * @return The settings; a function-local static, so that it is ready for settings
+         * constructed during static initialization.
+         */
+        static std::vector<InfoSettingHtml *> &background_settings();
+
+        std::function<void(const InfoSettingHtml &)> request_callback;    //!< The request callback; can be null.
+        uint32_t max_age;                   //!< The maximum age of the value, in milliseconds.
+        mutable uint32_t last_refresh;      //!< The `millis()` time of the last refresh.
+        mutable bool refreshed;             //!< Set when the value has been refreshed at least once.
+        bool background_refresh;            //!< If `true`, the value is refreshed in `loop` rather than on request.
     };
 }
\ No newline at end of file
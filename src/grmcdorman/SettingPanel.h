@@ -1,6 +1,5 @@
 #pragma once
 
-#include <ArduinoJson.h>
 #include <WString.h>
 #include <Stream.h>
 #include <ESPAsyncWebServer.h>
@@ -12,13 +11,21 @@ namespace grmcdorman
     /**
      * @brief The Setting Panel is the controller for a set of Setting.
      *
-     * It manages reading the values in from
-     * a POST request, and constructing the output JSON for the values when requested
-     * by the UI.
+     * It holds the panel's name and identifier, and selects
+     * the values to send when requested by the UI. POST requests
+     * are applied by `WebSettings`, using an index of all panels.
      */
     class SettingPanel
     {
     public:
+        //!< A setting name requested by the UI.
+        struct RequestedSetting
+        {
+            uint32_t hash;      //!< The hash of the name; see `name_hash`.
+            String name;        //!< The name.
+        };
+        typedef std::vector<RequestedSetting> requested_settings_t;     //!< Requested setting names, sorted by hash.
+
         /**
          * @brief Construct a new Setting Panel object.
          *
@@ -28,33 +35,23 @@ namespace grmcdorman
          */
         SettingPanel(const __FlashStringHelper *name, const __FlashStringHelper *identifier, const SettingInterface::settings_list_t &settings_set);
         /**
-         * @brief Handle a POST set-values request.
-         *
-         * All settings that are updated from the incoming request; if a setting
-         * does not appear, it is updated with its default (`set_default()`)
-         * if it is a setting that is sent on requests (`send_to_ui()` is `true`).
+         * @brief Determine whether a setting's value is to be sent to the UI.
          *
-         * Passwords are the only present case where `send_to_ui()` is `false`,
-         * meaning they are only set if explicitly included in the POST request.
+         * Settings without a name, and settings that have `send_to_ui()` returning `false`,
+         * are never sent, even if explicitly requested.
          *
-         * Note that some settings, notably note and info settings, ignore any attempt
-         * to set a value from this call.
-         * @param request
+         * @param setting               The setting.
+         * @param requested_settings    If not empty, send only the specific, named settings. Settings that do not exist are ignored.
+         * @return `true` if the setting's value is to be sent.
          */
-        void on_post(AsyncWebServerRequest *request);
+        static bool is_sent(const SettingInterface &setting, const requested_settings_t &requested_settings);
         /**
-         * @brief Construct JSON containing all sendable settings.
-         *
-         * Settings that have `send_to_ui()` returing `false` will be omitted,
-         * even if explicitly requested.
-         *
-         * The settings are inserted in the output document as an array under the key
-         * containing the panel name.
+         * @brief Add a name to a set of requested settings.
          *
-         * @param requested_settings    If not empty, include only the specific, named settings. Settings that do not exist are ignored.
-         * @return JSON document containing all settings (if `specific_setting` is empty) or the requested settings that exist.
+         * @param requested_settings    The requested settings.
+         * @param name                  The setting name.
          */
-        DynamicJsonDocument as_json(const std::vector<const String *> &requested_settings) const;
+        static void add_requested_setting(requested_settings_t &requested_settings, const String &name);
         /**
          * @brief Get the panel name.
          *
@@ -0,0 +1,236 @@
+// Generated by tools/build_assets.py from the files in assets/. Do not edit.
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <pgmspace.h>
+
+namespace grmcdorman
+{
+    namespace assets
+    {
+        //!< assets/style.css: 2547 bytes minified, 924 bytes compressed.
+        constexpr uint8_t style_css_gz[] PROGMEM = {
+            0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0xff, 0x9d, 0x55, 0x6b, 0x6f, 0xe3, 0x28,
+            0x14, 0xfd, 0x2b, 0x68, 0xaa, 0x6a, 0x5a, 0x4d, 0xec, 0xe2, 0x38, 0x8f, 0x19, 0xa3, 0x59, 0xed,
+            0x6f, 0xd8, 0xaf, 0xab, 0x55, 0x85, 0x79, 0x24, 0x4c, 0x09, 0x20, 0xc0, 0x6d, 0x52, 0x2b, 0xff,
+            0x7d, 0x01, 0x3f, 0xea, 0xe6, 0xd1, 0xa9, 0x26, 0x96, 0x12, 0x07, 0x2e, 0xe7, 0x9e, 0x7b, 0xee,
+            0x83, 0xdc, 0xe3, 0xba, 0xd5, 0xcf, 0xcc, 0x72, 0xa9, 0x5f, 0xaa, 0xad, 0xa0, 0x94, 0x29, 0x54,
+            0x6b, 0x4b, 0x99, 0xad, 0x0a, 0xb3, 0x07, 0x4e, 0x4b, 0x41, 0xc1, 0x0d, 0x21, 0x04, 0xd5, 0x98,
+            0x3c, 0x6d, 0xac, 0x6e, 0x14, 0xcd, 0x88, 0x96, 0xda, 0x56, 0x37, 0xbc, 0x88, 0xcf, 0x31, 0x0f,
+            0x18, 0xa0, 0x6e, 0xbc, 0xd7, 0xaa, 0x3d, 0x33, 0x12, 0x6a, 0xcb, 0xac, 0xf0, 0x28, 0xe0, 0x63,
+            0x5f, 0x49, 0xc6, 0xfd, 0x00, 0xaf, 0xb4, 0x62, 0x48, 0x37, 0x5e, 0x0a, 0xc5, 0xba, 0x3f, 0xa4,
+            0xb1, 0x2e, 0x1c, 0x31, 0x5a, 0x28, 0xcf, 0x2c, 0x32, 0x98, 0x52, 0xa1, 0x36, 0x55, 0xb1, 0x08,
+            0x44, 0x8a, 0x95, 0xd9, 0x23, 0x6f, 0xb1, 0x72, 0xc2, 0x0b, 0xad, 0x2a, 0x98, 0x97, 0x0e, 0x71,
+            0xad, 0x7c, 0xe6, 0xc4, 0x2b, 0xab, 0x8a, 0xb9, 0xf1, 0x53, 0x22, 0xd5, 0x36, 0x06, 0x75, 0x4e,
+            0xe7, 0x86, 0x52, 0x3a, 0xb5, 0xcb, 0x31, 0xf1, 0xe2, 0x99, 0x5d, 0x30, 0x0c, 0x21, 0x1f, 0xf3,
+            0x1d, 0x7d, 0xec, 0x03, 0xdb, 0x61, 0xbb, 0x11, 0x2a, 0xf3, 0xda, 0x54, 0x59, 0x09, 0x03, 0x17,
+            0xa3, 0x7b, 0x26, 0x96, 0x49, 0x1c, 0x31, 0xd0, 0xa9, 0x8c, 0xd9, 0x0b, 0xab, 0x9f, 0x84, 0xcf,
+            0x26, 0xac, 0xdf, 0xdc, 0x80, 0x05, 0x84, 0x3b, 0x87, 0x3e, 0xda, 0x1b, 0x54, 0xe6, 0xfc, 0x82,
+            0xf6, 0x10, 0xae, 0x56, 0x61, 0x63, 0xd0, 0x08, 0xe6, 0xf3, 0x25, 0xdb, 0x01, 0x98, 0x87, 0xef,
+            0x4e, 0x16, 0x8e, 0x77, 0x42, 0x1e, 0xaa, 0xaf, 0xff, 0xe8, 0x5a, 0x7b, 0xfd, 0x75, 0xe6, 0x82,
+            0xa3, 0xcc, 0x85, 0x5c, 0xf0, 0xa9, 0x6c, 0x36, 0x98, 0x0f, 0x39, 0x80, 0x43, 0x66, 0x86, 0x97,
+            0xcc, 0x62, 0x2a, 0x1a, 0x97, 0xc0, 0xa3, 0xe1, 0x10, 0x50, 0xad, 0xf7, 0x99, 0xdb, 0x62, 0x1a,
+            0x42, 0x85, 0x00, 0x46, 0xa7, 0x61, 0x17, 0xd8, 0x4d, 0x8d, 0xef, 0xe0, 0x2c, 0x3d, 0x79, 0x79,
+            0x8f, 0x3e, 0x67, 0x75, 0x92, 0xf3, 0x4e, 0xe6, 0x3e, 0x9c, 0x0e, 0x42, 0xbc, 0xc6, 0x00, 0x49,
+            0xe0, 0xcc, 0x54, 0xf2, 0x8d, 0x3c, 0xdb, 0xfb, 0x8c, 0x32, 0xa2, 0x2d, 0x4e, 0xca, 0xc5, 0xe2,
+            0x39, 0xe6, 0x56, 0x18, 0x23, 0xdf, 0x65, 0x72, 0x4c, 0x11, 0x61, 0x09, 0xfc, 0xe3, 0x84, 0xc0,
+            0xfc, 0xfb, 0xb5, 0x7c, 0xc4, 0xad, 0xc1, 0xc1, 0x59, 0x65, 0x55, 0x37, 0x65, 0xf9, 0x7d, 0xc9,
+            0x39, 0x88, 0x6a, 0x61, 0x99, 0x6d, 0xe2, 0x6f, 0x70, 0x78, 0x47, 0x84, 0x25, 0x92, 0xcd, 0x12,
+            0xa4, 0xc1, 0x36, 0x2c, 0x81, 0xe2, 0x76, 0x36, 0x58, 0x17, 0xb7, 0xf7, 0xa0, 0xe3, 0xf5, 0x50,
+            0x2c, 0x21, 0x84, 0xb7, 0xa3, 0x83, 0xab, 0x25, 0xb9, 0xa0, 0x3f, 0x16, 0xef, 0x8b, 0xa1, 0x4b,
+            0x62, 0x38, 0xfc, 0xbb, 0xd8, 0xae, 0x46, 0xe6, 0x26, 0x45, 0x9e, 0x5b, 0x46, 0x2f, 0xb8, 0xe5,
+            0xbc, 0x2c, 0x21, 0x1c, 0xe8, 0x45, 0xa3, 0x0b, 0x1a, 0x74, 0x46, 0x9f, 0xd5, 0xa0, 0xb7, 0xbe,
+            0xaa, 0x41, 0x72, 0x72, 0x55, 0x07, 0xce, 0x97, 0xa4, 0x2c, 0x8f, 0xb9, 0xf3, 0xd8, 0x37, 0xae,
+            0x1d, 0x7a, 0x60, 0x1e, 0xdb, 0xb2, 0x2f, 0xa0, 0xf8, 0x0e, 0xe0, 0x85, 0x49, 0xc6, 0x18, 0x1b,
+            0xaa, 0x3b, 0x0e, 0xa3, 0xec, 0x45, 0x50, 0xbf, 0xad, 0x96, 0xe1, 0xe4, 0x74, 0xb5, 0x77, 0xb4,
+            0x5e, 0xaf, 0x8f, 0x39, 0x15, 0x0e, 0xd7, 0x92, 0x3d, 0xc6, 0x90, 0x25, 0x3e, 0xb4, 0x63, 0x55,
+            0x71, 0xb1, 0x67, 0x14, 0xc5, 0x89, 0x00, 0x91, 0x15, 0x9b, 0xad, 0x4f, 0x8d, 0x13, 0x84, 0xdc,
+            0x85, 0x97, 0x08, 0x13, 0xff, 0x5f, 0x68, 0x5c, 0x88, 0xb4, 0xc1, 0x44, 0xf8, 0x43, 0x95, 0xaf,
+            0x97, 0xe8, 0x35, 0x13, 0x8a, 0xb2, 0x7d, 0xf5, 0xa3, 0xfb, 0xa0, 0xe0, 0xce, 0x04, 0x37, 0x7d,
+            0x51, 0x87, 0x49, 0xd5, 0x57, 0x7e, 0x3b, 0xdd, 0x18, 0xfb, 0x7e, 0x15, 0x47, 0xe3, 0x7c, 0x64,
+            0x7f, 0x36, 0xb3, 0xbb, 0x98, 0x22, 0xc7, 0x74, 0xac, 0x9f, 0x62, 0x89, 0x1c, 0x6e, 0xbc, 0x1e,
+            0x16, 0x3a, 0xfa, 0x71, 0x65, 0xea, 0xf2, 0x2f, 0xa1, 0x4c, 0xe3, 0x67, 0xd3, 0x15, 0xc7, 0x24,
+            0x23, 0x27, 0x4b, 0x06, 0xab, 0x36, 0x24, 0x19, 0xdb, 0x2a, 0x44, 0xbf, 0xed, 0x27, 0x7d, 0x42,
+            0x44, 0x9d, 0xba, 0xeb, 0x98, 0xd8, 0xc9, 0x09, 0x89, 0x6b, 0x26, 0xdb, 0xc9, 0x8d, 0xd0, 0x99,
+            0xcd, 0x97, 0xb7, 0x5d, 0x6b, 0x63, 0x29, 0x36, 0xaa, 0x47, 0x38, 0x19, 0x70, 0x45, 0x1c, 0x72,
+            0x00, 0x9e, 0xb3, 0xfc, 0xd7, 0x1f, 0x0c, 0xfb, 0xf9, 0x85, 0x6c, 0x19, 0x79, 0x0a, 0x33, 0xe2,
+            0xcb, 0x7f, 0x6d, 0x07, 0x9a, 0xa2, 0x9c, 0xb8, 0x1a, 0x07, 0xcc, 0x38, 0x2e, 0x03, 0x5e, 0x79,
+            0x42, 0xf0, 0x32, 0x22, 0xf8, 0x06, 0x3a, 0xe6, 0x13, 0xe4, 0x09, 0xdf, 0x08, 0x7f, 0xcc, 0x0d,
+            0x76, 0xee, 0x25, 0xa8, 0xfe, 0x18, 0xb3, 0x6e, 0xae, 0x71, 0x7b, 0x23, 0xf4, 0xe1, 0x89, 0x61,
+            0x6b, 0x8c, 0x86, 0x60, 0x49, 0xee, 0x62, 0xbf, 0x83, 0x0c, 0x94, 0xa1, 0x68, 0xef, 0xa7, 0x6a,
+            0x4f, 0x43, 0x18, 0xee, 0xb5, 0xa1, 0x68, 0x6a, 0xa9, 0xc9, 0xd3, 0xf1, 0x6f, 0xd7, 0x18, 0xa3,
+            0xad, 0x77, 0xe0, 0x6e, 0xd8, 0xd8, 0x58, 0x41, 0xef, 0xdb, 0x0f, 0x4e, 0x46, 0x83, 0x77, 0x75,
+            0x18, 0x17, 0x32, 0xcf, 0x76, 0x61, 0xd7, 0xb3, 0x58, 0xd5, 0xcd, 0x4e, 0xb9, 0xaa, 0xe0, 0x36,
+            0x25, 0xa7, 0xe4, 0x16, 0x25, 0x8b, 0x0d, 0x36, 0xf1, 0x92, 0x4e, 0x2a, 0xaf, 0xc2, 0x2c, 0x4f,
+            0x8b, 0x51, 0xb3, 0x2c, 0xdd, 0x91, 0xe1, 0x82, 0x74, 0x0c, 0x25, 0xe5, 0x32, 0x11, 0xd0, 0x5c,
+            0x3f, 0xa4, 0xdf, 0xe5, 0x81, 0x8a, 0xe7, 0xce, 0x5d, 0xe7, 0xa5, 0x2a, 0xc0, 0xc3, 0x02, 0x4d,
+            0xd4, 0x1f, 0x92, 0xf9, 0x87, 0x45, 0x3b, 0x85, 0x9e, 0x83, 0x07, 0xf0, 0x7b, 0xec, 0x0e, 0xa9,
+            0xfd, 0x44, 0xd7, 0x9c, 0xe7, 0xfc, 0x24, 0x10, 0x50, 0xa2, 0x5f, 0x8d, 0xf3, 0x82, 0x1f, 0xc2,
+            0xad, 0x2c, 0x79, 0xc5, 0x14, 0xbd, 0xec, 0x33, 0xd5, 0xdc, 0xec, 0xcf, 0xca, 0x73, 0xec, 0x9e,
+            0x37, 0xe8, 0xe3, 0xff, 0x30, 0x1d, 0xda, 0xbc, 0xf3, 0x09, 0x00, 0x00,
+        };
+        constexpr size_t style_css_gz_length = 924;    //!< Length of `style_css_gz`.
+        constexpr uint32_t style_css_gz_hash = 0xa8b2c618;    //!< FNV-1a hash of `style_css_gz`.
+
+        //!< assets/script.js: 7336 bytes minified, 2439 bytes compressed.
+        constexpr uint8_t script_js_gz[] PROGMEM = {
+            0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0xff, 0xbd, 0x59, 0x5b, 0x6f, 0xdb, 0x3a,
+            0x12, 0x7e, 0xf7, 0xaf, 0x60, 0x84, 0xa2, 0x96, 0xd7, 0x8a, 0xe2, 0x9c, 0xdd, 0xf3, 0x52, 0xc7,
+            0x09, 0xd2, 0x34, 0x3d, 0xc9, 0x6e, 0x73, 0x41, 0x2e, 0xdd, 0x02, 0x69, 0x50, 0xd0, 0x16, 0x1d,
+            0x33, 0x91, 0x25, 0x95, 0xa4, 0x92, 0x7a, 0x7b, 0xf2, 0xdf, 0x77, 0x86, 0x17, 0x89, 0xb2, 0xe5,
+            0xb4, 0xdb, 0x5d, 0x2c, 0x0a, 0x04, 0x32, 0x39, 0x33, 0x9c, 0xfb, 0x7c, 0x64, 0xa7, 0x65, 0x36,
+            0x51, 0x3c, 0xcf, 0x48, 0x5e, 0xb0, 0xec, 0x8a, 0x8e, 0x43, 0xf6, 0xa8, 0x22, 0xa2, 0xe8, 0xf8,
+            0x94, 0xce, 0x59, 0x8f, 0x7c, 0xef, 0x3c, 0x52, 0x41, 0xb8, 0x5e, 0x99, 0xe4, 0x99, 0x62, 0x99,
+            0xd9, 0x4d, 0x79, 0xf6, 0x20, 0x87, 0x9d, 0x7a, 0x95, 0x8c, 0x48, 0x92, 0x4f, 0xca, 0x39, 0x7c,
+            0xc6, 0x77, 0x4c, 0x1d, 0xa6, 0x0c, 0x3f, 0xe5, 0xdb, 0xc5, 0x41, 0x4a, 0xa5, 0x44, 0x61, 0x61,
+            0x50, 0x53, 0x07, 0xbd, 0x61, 0x67, 0x9a, 0x0b, 0x12, 0x72, 0xe0, 0x1b, 0x0c, 0x09, 0x27, 0x3b,
+            0xde, 0x09, 0x71, 0xca, 0xb2, 0x3b, 0x35, 0x83, 0xe5, 0x7e, 0x1f, 0x55, 0xa8, 0x77, 0x6e, 0xf8,
+            0x6d, 0x3c, 0x71, 0x02, 0x81, 0x75, 0xcd, 0x4e, 0x2c, 0x58, 0x91, 0xd2, 0x09, 0x1c, 0x49, 0x28,
+            0x58, 0xf7, 0xc8, 0x82, 0x88, 0x04, 0x41, 0xcf, 0x5b, 0x9e, 0xf1, 0x24, 0x61, 0x99, 0x59, 0x26,
+            0xfd, 0x4e, 0xd8, 0x14, 0xc4, 0x13, 0x32, 0x1a, 0x8d, 0x9c, 0x17, 0xc8, 0x1e, 0xa9, 0xe4, 0x90,
+            0x37, 0xa4, 0x62, 0x06, 0x1b, 0x9e, 0x3b, 0xce, 0x17, 0x3f, 0x69, 0xbf, 0xa6, 0x5d, 0x63, 0xbd,
+            0xde, 0x6b, 0xb1, 0x5d, 0xaf, 0xb7, 0x58, 0xbe, 0xba, 0xbe, 0xc6, 0x6e, 0xd4, 0x13, 0xc2, 0x1a,
+            0x4f, 0x4a, 0x21, 0x40, 0xa9, 0x2b, 0x2a, 0x40, 0x43, 0x4f, 0x5a, 0x7f, 0x54, 0x1b, 0x38, 0xec,
+            0xa4, 0x39, 0x4d, 0x20, 0x11, 0x0e, 0x8c, 0x3b, 0x42, 0x97, 0x0a, 0x28, 0x64, 0xea, 0x92, 0x45,
+            0x30, 0x25, 0x16, 0xef, 0x58, 0x4a, 0x17, 0xa1, 0x60, 0x5f, 0x51, 0x4f, 0x3e, 0x25, 0xf8, 0x19,
+            0x4b, 0x45, 0x55, 0x29, 0xc9, 0x06, 0xb8, 0xef, 0xf7, 0xc1, 0x5f, 0x71, 0x07, 0x68, 0x4b, 0x91,
+            0x91, 0xcd, 0x6d, 0x94, 0x80, 0xd9, 0x24, 0x19, 0xb8, 0x3a, 0x41, 0x8f, 0x15, 0x54, 0x48, 0x76,
+            0x0c, 0x87, 0x20, 0x27, 0xe8, 0x74, 0xc1, 0x64, 0x91, 0x67, 0x92, 0x1d, 0x31, 0x9a, 0x30, 0x11,
+            0x06, 0x17, 0x78, 0xcc, 0xe6, 0xfe, 0x54, 0x31, 0x11, 0xf4, 0x22, 0xb2, 0x3d, 0x00, 0x2d, 0xac,
+            0xb8, 0x90, 0x83, 0xee, 0xa7, 0xa1, 0x95, 0xd5, 0x83, 0x18, 0xfd, 0x06, 0xb1, 0xa9, 0x7e, 0xfe,
+            0x05, 0x88, 0x07, 0x03, 0xd2, 0x27, 0x27, 0x54, 0xcd, 0x62, 0x41, 0xb3, 0x24, 0x9f, 0x87, 0x6e,
+            0xb9, 0x56, 0x44, 0x29, 0x9e, 0xdd, 0xc9, 0xcb, 0xc9, 0x8c, 0xcd, 0x29, 0xe8, 0x93, 0x95, 0x69,
+            0x3a, 0xac, 0xad, 0x44, 0x4f, 0x98, 0xbd, 0x70, 0x42, 0xd3, 0x74, 0x4c, 0x27, 0x0f, 0xce, 0xd4,
+            0x25, 0x56, 0x34, 0x17, 0x99, 0x71, 0xdb, 0x91, 0x86, 0x95, 0xb2, 0xee, 0x3c, 0xb0, 0x12, 0x0f,
+            0x61, 0x4f, 0xe4, 0xd3, 0xc9, 0x87, 0x23, 0xa5, 0x8a, 0x0b, 0xf6, 0xb5, 0x64, 0x52, 0x19, 0xca,
+            0xaf, 0x71, 0xfe, 0xc8, 0x84, 0xe0, 0x09, 0x3b, 0xe1, 0x73, 0x76, 0xb5, 0x28, 0x20, 0x8c, 0xb4,
+            0x28, 0x52, 0x3e, 0xa1, 0xa8, 0xcd, 0xd6, 0xbd, 0xcc, 0x75, 0xce, 0x69, 0x4a, 0x28, 0xd6, 0x30,
+            0xf8, 0xe3, 0xf0, 0x0a, 0x03, 0xbc, 0xe5, 0x94, 0xd9, 0x92, 0x5a, 0x1b, 0x58, 0x53, 0xa2, 0x64,
+            0x8e, 0x34, 0x43, 0x33, 0xe0, 0xdc, 0xca, 0xac, 0xd0, 0x95, 0x75, 0x82, 0x01, 0x84, 0x1d, 0x2f,
+            0x9a, 0x6a, 0xc6, 0x25, 0x30, 0xa2, 0x89, 0x66, 0x77, 0x17, 0x32, 0x14, 0xe9, 0xe1, 0x8c, 0x2b,
+            0x50, 0x2b, 0x2f, 0x55, 0xd8, 0x10, 0xd4, 0xea, 0xa4, 0x21, 0x79, 0x8e, 0x8c, 0xf4, 0x86, 0x0f,
+            0x50, 0x2a, 0x1e, 0xe0, 0x92, 0x04, 0x6b, 0xec, 0xb7, 0x81, 0x13, 0xdf, 0x0c, 0xc5, 0xdf, 0x2f,
+            0xcf, 0x4e, 0x63, 0x9d, 0x1f, 0x86, 0x45, 0xd8, 0xd4, 0xb8, 0x62, 0xdf, 0x94, 0xce, 0x45, 0xdf,
+            0xcd, 0xcf, 0xce, 0x54, 0xf0, 0x1f, 0xd4, 0xd5, 0x88, 0xb8, 0x4d, 0xb3, 0x2e, 0x59, 0x96, 0x84,
+            0x3a, 0x3c, 0x4b, 0x49, 0x9c, 0x41, 0x96, 0x5d, 0x9a, 0x93, 0xc3, 0x82, 0x66, 0x2c, 0x3d, 0x4e,
+            0x22, 0x22, 0x9d, 0x7b, 0x4a, 0x6c, 0x03, 0xc4, 0xae, 0x43, 0x2a, 0x05, 0xaf, 0x02, 0xf8, 0x2b,
+            0xe3, 0x2c, 0xea, 0x4c, 0x39, 0x4b, 0x75, 0x06, 0x77, 0x79, 0x32, 0x0a, 0xba, 0xb0, 0x8c, 0xc4,
+            0x7d, 0xd2, 0x0d, 0x48, 0x06, 0xc5, 0xd2, 0x5c, 0xea, 0x46, 0x9d, 0x94, 0x8e, 0x59, 0x8a, 0xe4,
+            0x3b, 0xe6, 0x0b, 0xaa, 0xbf, 0x49, 0xb3, 0xdb, 0xd5, 0xa2, 0xf5, 0x8f, 0x9d, 0x2d, 0x4d, 0xb4,
+            0x0b, 0x7c, 0x33, 0x35, 0x4f, 0xa3, 0x0e, 0x1f, 0x76, 0xe4, 0x13, 0x57, 0x93, 0x19, 0xe4, 0x5d,
+            0xac, 0x4c, 0x8e, 0x49, 0x46, 0x82, 0x2c, 0x57, 0x2c, 0x78, 0xe3, 0x2a, 0xa2, 0xbb, 0x93, 0xf0,
+            0x47, 0xa2, 0xab, 0x7a, 0x64, 0xb6, 0x9a, 0x42, 0x61, 0x77, 0xb7, 0x3b, 0xb4, 0xac, 0x3c, 0x9b,
+            0xe6, 0x3e, 0xab, 0x04, 0x33, 0x1d, 0xaf, 0xde, 0x23, 0xc8, 0x6b, 0xcd, 0x04, 0xf6, 0xdd, 0x9d,
+            0x2d, 0x24, 0xd1, 0x12, 0xb5, 0x76, 0x4e, 0x50, 0x01, 0x2c, 0x4f, 0xb9, 0x48, 0xd6, 0x09, 0x73,
+            0xfb, 0x5f, 0xee, 0x44, 0x5e, 0x16, 0xc1, 0xee, 0x0e, 0xcf, 0x8a, 0x52, 0x11, 0x05, 0xe9, 0x3d,
+            0x0a, 0x20, 0xd8, 0x93, 0x87, 0x71, 0xfe, 0x2d, 0x20, 0xce, 0x8d, 0xb5, 0xb7, 0xbb, 0xaf, 0x8a,
+            0xa7, 0x57, 0xc6, 0x80, 0x0c, 0x3a, 0x34, 0x78, 0x36, 0xcf, 0x26, 0x33, 0x9a, 0xdd, 0xb1, 0xd1,
+            0xe7, 0x6e, 0x4b, 0xab, 0x7d, 0xbb, 0x38, 0x4e, 0xc2, 0x86, 0x4f, 0x7b, 0x71, 0xc2, 0x25, 0xb4,
+            0x49, 0x86, 0x61, 0xdc, 0x60, 0x8f, 0x48, 0xaf, 0x6c, 0xef, 0xc3, 0x83, 0x59, 0x32, 0xfc, 0xdc,
+            0x45, 0x8b, 0x3a, 0xdd, 0x86, 0x56, 0x95, 0x49, 0x4b, 0x3e, 0x20, 0x4e, 0xdc, 0x28, 0xc0, 0xfa,
+            0x0a, 0xd6, 0xfa, 0x44, 0xb2, 0x94, 0x4d, 0x14, 0x78, 0x04, 0xc3, 0xa7, 0xa3, 0x6e, 0x56, 0x96,
+            0x7d, 0xda, 0x5d, 0x1d, 0x03, 0x32, 0xce, 0xab, 0x09, 0xd0, 0xef, 0x73, 0x8c, 0xb5, 0x16, 0xd2,
+            0x47, 0x29, 0x79, 0xa1, 0xf3, 0x76, 0x25, 0xc3, 0xbe, 0xe0, 0x37, 0x48, 0xe9, 0x93, 0xed, 0x9e,
+            0x9f, 0x4d, 0x39, 0x0c, 0x07, 0x13, 0x7b, 0xc3, 0x89, 0x07, 0x3e, 0xbb, 0x30, 0x19, 0xb1, 0xb8,
+            0x69, 0x94, 0xf3, 0xcd, 0x48, 0xd8, 0x94, 0x96, 0xa9, 0xf2, 0x42, 0xea, 0xfb, 0xc7, 0x08, 0x57,
+            0x26, 0xdd, 0x7d, 0x93, 0x3a, 0x90, 0x9e, 0x73, 0x9e, 0xe9, 0x6e, 0x58, 0x42, 0x6d, 0x4d, 0x79,
+            0x06, 0xbe, 0xdf, 0x03, 0x1a, 0x58, 0x75, 0x7c, 0x48, 0xa0, 0xab, 0x02, 0xda, 0x75, 0xb7, 0xdb,
+            0x33, 0x5c, 0x52, 0xb1, 0xa2, 0x85, 0x0d, 0x97, 0x1d, 0x9f, 0x26, 0x69, 0x30, 0x02, 0xc1, 0x96,
+            0xaf, 0xf5, 0xf3, 0x6a, 0x71, 0x9f, 0x63, 0x3a, 0x99, 0xd2, 0x76, 0x55, 0x5d, 0xc5, 0xc4, 0x37,
+            0xc9, 0x4e, 0x74, 0xcf, 0xb5, 0x9a, 0x27, 0xe6, 0x3a, 0x11, 0x03, 0xf2, 0x48, 0xd3, 0x12, 0x36,
+            0xb6, 0x83, 0x2a, 0x66, 0x1a, 0x16, 0xd5, 0x71, 0x33, 0xe4, 0x72, 0x5d, 0xec, 0x5a, 0x5a, 0x4d,
+            0x0c, 0xa0, 0xca, 0x72, 0x41, 0x98, 0x7a, 0x6d, 0x91, 0xc1, 0x7a, 0x96, 0x6a, 0x91, 0x62, 0xa5,
+            0xa4, 0x8c, 0x8a, 0x37, 0x64, 0x9c, 0xab, 0x19, 0xe6, 0x9d, 0xad, 0xe5, 0xe7, 0xe6, 0xac, 0x6a,
+            0x99, 0xda, 0xd6, 0x68, 0xf8, 0xd9, 0x0e, 0x50, 0x74, 0xd5, 0xd4, 0x23, 0x5e, 0x77, 0x68, 0x3a,
+            0x46, 0x82, 0x7d, 0xa5, 0x04, 0x1f, 0x97, 0x0a, 0xa6, 0x50, 0x42, 0x15, 0xdd, 0x4c, 0xe9, 0xbf,
+            0x16, 0x80, 0x95, 0x30, 0x48, 0x26, 0xfd, 0xeb, 0xd9, 0x6e, 0x71, 0x10, 0xf4, 0xd9, 0x76, 0x2e,
+            0x98, 0x51, 0xa8, 0x1e, 0x98, 0x8e, 0xf3, 0xcb, 0x1b, 0x18, 0xab, 0x23, 0x49, 0x7b, 0xa4, 0x9e,
+            0xc4, 0x4b, 0x9e, 0x5e, 0x33, 0x75, 0xc9, 0xeb, 0xd7, 0xa6, 0x78, 0x1a, 0xdb, 0xcb, 0xb1, 0x58,
+            0x1d, 0xdb, 0x1a, 0xea, 0xf9, 0x48, 0x0f, 0xc9, 0x9c, 0x06, 0x2b, 0xa4, 0x26, 0xc1, 0x50, 0x8a,
+            0x25, 0xf1, 0x66, 0xfe, 0x0f, 0xac, 0x37, 0xfe, 0x1a, 0x2e, 0xb9, 0x8b, 0x67, 0x30, 0xaf, 0x8e,
+            0xae, 0x4e, 0x3e, 0x90, 0x51, 0x4b, 0xba, 0x6a, 0x70, 0x0d, 0x63, 0x6f, 0x0e, 0xa8, 0xa0, 0x3d,
+            0x16, 0x43, 0x03, 0x62, 0x26, 0x82, 0x17, 0x4a, 0x1a, 0x48, 0xd8, 0x84, 0x9e, 0x57, 0xf4, 0xce,
+            0x00, 0x4f, 0x43, 0xd3, 0x06, 0x3b, 0x2d, 0xf7, 0xb2, 0xaf, 0x6a, 0xc1, 0x7e, 0xda, 0x4c, 0x04,
+            0xa3, 0x8a, 0x59, 0xf9, 0xbe, 0x54, 0xf3, 0x15, 0x2b, 0x98, 0xcd, 0xe8, 0x39, 0x23, 0x13, 0xbd,
+            0x8b, 0x2b, 0x6e, 0x5b, 0x2f, 0xc0, 0x44, 0x07, 0xde, 0xd3, 0x3c, 0xa9, 0xb0, 0xea, 0xc1, 0x8c,
+            0xa7, 0x49, 0x68, 0x48, 0x22, 0x8f, 0xd7, 0x56, 0x84, 0xcd, 0x6b, 0x1f, 0x86, 0xf6, 0x1c, 0x9e,
+            0xd2, 0x55, 0xf9, 0x91, 0x09, 0x09, 0x29, 0x84, 0x0e, 0xf8, 0xfe, 0x3c, 0xf4, 0x1b, 0x80, 0xc6,
+            0x56, 0x1f, 0x91, 0x46, 0x86, 0xf0, 0x2d, 0x16, 0x11, 0xe1, 0x19, 0xd8, 0x80, 0xda, 0xd3, 0xaa,
+            0x1f, 0xac, 0x07, 0x65, 0x51, 0xa7, 0x14, 0x98, 0x09, 0x1e, 0xc0, 0x02, 0xf7, 0xee, 0x21, 0x08,
+            0xd0, 0xe2, 0x4c, 0xb9, 0x78, 0x22, 0x31, 0x0f, 0x1b, 0x3a, 0xdd, 0x68, 0xba, 0xdb, 0x66, 0x67,
+            0xc3, 0x83, 0x51, 0x30, 0xa2, 0xee, 0xd7, 0x12, 0xd8, 0xa1, 0xbc, 0x41, 0x64, 0x1b, 0xa3, 0x71,
+            0xc1, 0xaf, 0x02, 0x43, 0x38, 0xe4, 0xff, 0x8a, 0x04, 0x7f, 0xe8, 0xf1, 0x9f, 0x84, 0x85, 0x1b,
+            0x35, 0x2c, 0x6c, 0xe2, 0xe7, 0x47, 0xe3, 0x1d, 0x4c, 0x75, 0x24, 0x6f, 0xb9, 0x30, 0x7c, 0xda,
+            0xb4, 0x3d, 0x56, 0x6e, 0x5a, 0x57, 0x06, 0xd6, 0x06, 0xc7, 0xeb, 0x23, 0xf5, 0xd6, 0x58, 0x8d,
+            0xdc, 0x31, 0x78, 0x2a, 0xba, 0x79, 0x61, 0x0d, 0x7a, 0x11, 0x91, 0xd6, 0x20, 0x74, 0x2d, 0xd8,
+            0x44, 0xe7, 0xef, 0xa7, 0x29, 0x24, 0xb3, 0x0c, 0xbd, 0xbe, 0xfc, 0x8b, 0xf7, 0xe7, 0x08, 0xdb,
+            0x03, 0x26, 0xfd, 0xcd, 0x6d, 0xfb, 0x44, 0x5a, 0x7f, 0x9d, 0x46, 0x77, 0x6c, 0x34, 0x2f, 0xbc,
+            0x33, 0x2a, 0xdb, 0x7b, 0x8c, 0x6d, 0x6e, 0x32, 0x2e, 0x4a, 0x39, 0xd3, 0x1a, 0xe8, 0x64, 0x65,
+            0xd9, 0x04, 0x4a, 0xf8, 0xfa, 0xe2, 0xf8, 0x20, 0x9f, 0x83, 0x13, 0xec, 0xc4, 0x69, 0xdc, 0xa0,
+            0xb5, 0x4b, 0x5c, 0x74, 0x51, 0x82, 0xd1, 0x42, 0x07, 0xc0, 0xc6, 0xd6, 0x4f, 0x17, 0x4d, 0x72,
+            0x9f, 0x73, 0xc8, 0xde, 0xd7, 0x81, 0xe3, 0xad, 0xbc, 0xe7, 0xc7, 0x41, 0x38, 0xe7, 0x3d, 0x80,
+            0xb1, 0x67, 0xe3, 0x7b, 0xc0, 0x2e, 0xf1, 0x03, 0x5b, 0xe0, 0x46, 0xbb, 0x27, 0x1e, 0x1a, 0xdd,
+            0xad, 0xf3, 0xbd, 0x26, 0xba, 0x37, 0x44, 0xf7, 0x40, 0x24, 0x6e, 0x1e, 0x40, 0xef, 0x5b, 0x8f,
+            0xf4, 0x1e, 0x49, 0x21, 0xd9, 0x71, 0xa4, 0x8a, 0x3c, 0xd5, 0xa7, 0x87, 0x48, 0x14, 0x39, 0xe2,
+            0x9b, 0xfb, 0x5b, 0xab, 0xe8, 0x4a, 0xa0, 0x75, 0xcb, 0x5a, 0xb5, 0xf2, 0x45, 0x07, 0xf6, 0x9a,
+            0x19, 0xb3, 0x7c, 0x34, 0x74, 0x47, 0xac, 0x74, 0x67, 0x3d, 0x33, 0x19, 0xf2, 0xd2, 0x58, 0xaf,
+            0xee, 0x2c, 0xc8, 0x17, 0x23, 0xb6, 0xd1, 0x69, 0x73, 0x07, 0x7f, 0xa0, 0x89, 0x98, 0xba, 0xa8,
+            0xc4, 0x78, 0x75, 0xe1, 0x8f, 0xa9, 0x3b, 0x38, 0xc0, 0xd2, 0x00, 0x78, 0xd6, 0xf3, 0x24, 0x56,
+            0xf9, 0x75, 0x51, 0x30, 0x71, 0x00, 0x60, 0x37, 0xec, 0x35, 0xc4, 0xc4, 0x28, 0x78, 0xb5, 0xdd,
+            0xe9, 0x55, 0x4f, 0x0e, 0xfc, 0x6c, 0x0a, 0x21, 0x55, 0x1f, 0xc0, 0x03, 0x11, 0x62, 0xbc, 0x3b,
+            0xfe, 0x18, 0x90, 0x3f, 0xff, 0x24, 0xd5, 0xc2, 0xe5, 0xf9, 0xfe, 0xa9, 0xc6, 0x1c, 0x4e, 0x8a,
+            0x3f, 0x3e, 0xb5, 0x81, 0xba, 0x9c, 0x41, 0x10, 0x9c, 0x03, 0x28, 0xbc, 0x21, 0xed, 0xf8, 0xf4,
+            0xfc, 0xfa, 0x2a, 0xc0, 0xfe, 0x6c, 0x54, 0x81, 0xa5, 0xd3, 0xeb, 0x93, 0xb7, 0x87, 0x17, 0x0d,
+            0x89, 0x5a, 0x80, 0x7b, 0x96, 0x78, 0x0f, 0x61, 0x54, 0x61, 0x2d, 0xb8, 0xf7, 0xd3, 0x92, 0x0f,
+            0x8e, 0x0e, 0x0f, 0xfe, 0xf1, 0xf6, 0xec, 0x53, 0x43, 0xb6, 0xbd, 0x71, 0x34, 0x74, 0x35, 0xd0,
+            0x43, 0x78, 0x4a, 0xaf, 0xea, 0xd2, 0xb0, 0x0c, 0xfe, 0x3d, 0xf1, 0x2c, 0xc9, 0x9f, 0x62, 0x9a,
+            0x24, 0x87, 0x78, 0xa1, 0xf9, 0xc0, 0x01, 0x17, 0x67, 0xd8, 0xfa, 0x30, 0xeb, 0xa0, 0xe9, 0x37,
+            0xfa, 0x4c, 0x6f, 0xe8, 0xa7, 0x53, 0x96, 0xbc, 0x83, 0xc2, 0x0e, 0x33, 0x0b, 0x74, 0xd6, 0xde,
+            0xa1, 0xec, 0x35, 0xe7, 0x0b, 0x4e, 0x1d, 0xe8, 0xd5, 0x70, 0x8f, 0xd2, 0x20, 0x14, 0x6f, 0x53,
+            0x85, 0x19, 0x13, 0xc1, 0x38, 0xcd, 0x27, 0x0f, 0x81, 0x01, 0x20, 0x9f, 0x8e, 0x2e, 0xd6, 0x0e,
+            0x50, 0xa8, 0xb4, 0xf9, 0x0b, 0x19, 0x9a, 0xe9, 0xd7, 0x27, 0x12, 0x7c, 0x41, 0x3a, 0xec, 0x69,
+            0xef, 0xdf, 0x59, 0x51, 0xef, 0x61, 0x41, 0x6b, 0x4b, 0xb4, 0x08, 0x30, 0x04, 0x8e, 0x59, 0x6f,
+            0xb5, 0xb3, 0x32, 0xd4, 0xb7, 0x3c, 0xd7, 0xe4, 0x9a, 0x6f, 0x0d, 0x7a, 0xa6, 0x40, 0x49, 0xd3,
+            0x94, 0x09, 0x40, 0x2f, 0x97, 0xf4, 0x11, 0xc2, 0xe1, 0x26, 0xbb, 0x7d, 0x24, 0xab, 0xc2, 0xdb,
+            0xe4, 0xfc, 0xdb, 0x60, 0xdb, 0xe7, 0xb4, 0x3c, 0x04, 0x2e, 0xd9, 0x44, 0xa2, 0x98, 0x88, 0xd0,
+            0x52, 0xcd, 0xe0, 0x64, 0x3b, 0x92, 0xc9, 0x94, 0x72, 0xb8, 0x27, 0xd6, 0x42, 0x5f, 0x66, 0x96,
+            0x4c, 0x80, 0xab, 0x89, 0x1b, 0x28, 0xf8, 0xc4, 0xd8, 0x27, 0x9e, 0x0a, 0xd5, 0x9b, 0xc7, 0x7f,
+            0x13, 0xb2, 0x0c, 0xba, 0x4c, 0x60, 0xd0, 0x53, 0xbb, 0x2b, 0xf5, 0xdb, 0x89, 0xef, 0x4b, 0xa2,
+            0x9d, 0x49, 0xd0, 0x9b, 0x4e, 0xf9, 0x72, 0x3c, 0xe7, 0x5a, 0xff, 0xca, 0x71, 0x9e, 0xa9, 0xff,
+            0x43, 0xed, 0x0c, 0x8c, 0x39, 0x3f, 0xbb, 0x34, 0x0f, 0x5c, 0xe8, 0x0f, 0x97, 0x2b, 0x08, 0xc6,
+            0x02, 0x4b, 0xa6, 0x67, 0x2d, 0x81, 0xa4, 0xa9, 0x20, 0x21, 0x74, 0x14, 0x9e, 0x27, 0x7c, 0x72,
+            0x5d, 0xc0, 0x10, 0x63, 0x68, 0x9c, 0x1d, 0x91, 0xba, 0x65, 0xa2, 0x3d, 0x12, 0x9a, 0x6a, 0x06,
+            0x33, 0x43, 0xd7, 0xe2, 0x94, 0x42, 0x70, 0xec, 0xb5, 0x07, 0xca, 0x37, 0x9f, 0x12, 0xed, 0x94,
+            0xcb, 0xbc, 0x14, 0x13, 0xd3, 0xc7, 0x82, 0xaa, 0x91, 0x05, 0x15, 0x30, 0xb6, 0xa6, 0x6b, 0x52,
+            0x69, 0x13, 0xd6, 0xe3, 0x0b, 0x3d, 0xc0, 0x68, 0x8e, 0xd4, 0x18, 0xb9, 0xc1, 0x05, 0x60, 0x0c,
+            0x6d, 0x5c, 0x01, 0x63, 0xab, 0x2a, 0xda, 0xfe, 0xd0, 0x22, 0xc0, 0x3d, 0x76, 0xfd, 0x48, 0x82,
+            0x35, 0x72, 0x55, 0xc4, 0x6a, 0x0e, 0xe8, 0x46, 0x23, 0xbd, 0x24, 0x20, 0x75, 0x45, 0xad, 0xc1,
+            0x42, 0xe6, 0x5d, 0x05, 0x21, 0x43, 0xaf, 0x02, 0xe7, 0x15, 0x37, 0x97, 0xe7, 0x80, 0x1b, 0x98,
+            0xbe, 0x62, 0x46, 0x30, 0xf4, 0x00, 0x5d, 0xfe, 0x07, 0xf3, 0x0b, 0x2e, 0xad, 0x6e, 0x82, 0x69,
+            0xd6, 0x58, 0x96, 0x63, 0x09, 0x28, 0x05, 0xae, 0xd0, 0xe6, 0x37, 0xf4, 0x42, 0xf6, 0xed, 0x6c,
+            0x1a, 0x06, 0x23, 0x7c, 0xc5, 0x27, 0xdb, 0xbd, 0xfa, 0x7d, 0x78, 0xd9, 0x0d, 0xd0, 0xa0, 0xdd,
+            0x89, 0xfe, 0xb5, 0xb1, 0x6a, 0xcf, 0xf5, 0xd3, 0x3a, 0x06, 0x5d, 0x3f, 0x81, 0x35, 0x2c, 0x69,
+            0x26, 0x56, 0xe8, 0x5a, 0xcc, 0x6a, 0xbe, 0x35, 0x71, 0x4e, 0xc7, 0x18, 0x6b, 0x1e, 0xd7, 0xaf,
+            0xd6, 0xdd, 0xc2, 0xd7, 0xc1, 0x3c, 0xf7, 0x28, 0xdf, 0xbb, 0x19, 0x20, 0xa4, 0x8a, 0x3a, 0x4f,
+            0xb3, 0x3c, 0xb5, 0x62, 0x74, 0x54, 0xa3, 0x2a, 0xa4, 0x58, 0x44, 0xc1, 0x9a, 0xb7, 0x89, 0x75,
+            0x3a, 0x56, 0x80, 0xa8, 0xdd, 0x12, 0x7c, 0x3d, 0x02, 0x23, 0x2a, 0xdd, 0x91, 0xd2, 0x53, 0xc0,
+            0x26, 0x66, 0xdd, 0x34, 0x5b, 0x25, 0x78, 0x31, 0x1b, 0x44, 0xb5, 0x2c, 0xe7, 0x25, 0xfd, 0x64,
+            0x85, 0x2e, 0x0f, 0x6b, 0x17, 0x41, 0xcc, 0x01, 0x02, 0x42, 0x74, 0x3a, 0x1b, 0x55, 0xfe, 0x54,
+            0xbb, 0x11, 0x69, 0x3d, 0xa6, 0x67, 0xc1, 0x9a, 0xf1, 0x05, 0x5c, 0xad, 0x7e, 0xa4, 0xcc, 0xb2,
+            0x26, 0x1e, 0x5a, 0x75, 0x36, 0xa2, 0xc8, 0x9f, 0x87, 0x6f, 0xb5, 0x9b, 0xaa, 0x4b, 0x97, 0xe7,
+            0x9b, 0x4a, 0x35, 0xdd, 0x53, 0x82, 0x5f, 0x15, 0x8d, 0x2f, 0x61, 0x56, 0x92, 0x77, 0x0a, 0xfe,
+            0x83, 0xe5, 0x63, 0xc8, 0x19, 0x01, 0x15, 0xbc, 0x14, 0x88, 0x88, 0xfc, 0x3e, 0x18, 0x0c, 0x7c,
+            0x28, 0x30, 0x05, 0x81, 0xb9, 0x58, 0xc0, 0xe5, 0x89, 0xa9, 0x2a, 0x93, 0x21, 0xe5, 0xa6, 0x5c,
+            0xcc, 0xf1, 0x3f, 0x5d, 0x60, 0x99, 0x50, 0xa8, 0x0f, 0x95, 0x3b, 0x52, 0x62, 0x5f, 0x04, 0xe5,
+            0x1b, 0x3d, 0x97, 0xc8, 0x13, 0x87, 0x6d, 0x26, 0xf0, 0xb5, 0x13, 0x09, 0x6b, 0x9d, 0xe0, 0xba,
+            0x97, 0x96, 0xf8, 0xd2, 0x43, 0xfe, 0xc9, 0xdf, 0xf3, 0xcf, 0x59, 0xbc, 0x2f, 0x18, 0x59, 0xe4,
+            0x25, 0x91, 0xa5, 0x60, 0x7b, 0xe6, 0x3e, 0x51, 0x15, 0x00, 0x80, 0x08, 0x33, 0x2e, 0xf1, 0x8e,
+            0x6d, 0x4f, 0x12, 0x78, 0xfa, 0x9e, 0x55, 0x66, 0xa4, 0x1f, 0x4e, 0xb4, 0x89, 0xff, 0x06, 0x58,
+            0xf2, 0xca, 0xf0, 0xa8, 0x1c, 0x00, 0x00,
+        };
+        constexpr size_t script_js_gz_length = 2439;    //!< Length of `script_js_gz`.
+        constexpr uint32_t script_js_gz_hash = 0xd8ec362d;    //!< FNV-1a hash of `script_js_gz`.
+    }
+}
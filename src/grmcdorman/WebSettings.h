@@ -1,11 +1,16 @@
 #pragma once
 
-#include <list>
+#include <algorithm>
+#include <cstddef>
+#include <functional>
 #include <unordered_map>
 #include <memory>
+#include <vector>
 
 #include <WString.h>
+#include <FS.h>
 #include <ESPAsyncWebServer.h>
+#include <bearssl/bearssl_hash.h>
 
 #include "grmcdorman/SettingPanel.h"
 
@@ -22,21 +27,46 @@ namespace grmcdorman
      * @section overview_sec Overview
      * The server supports the following pages or requests:
      *  * "/": The root page. This contains the setting panels, and five buttons, `Save`, `Reset Form`, `Reboot`, `Factory Defaults`, and `Uplaod Firmware`.
-     *  * "/style.css": CSS styles for the root page.
-     *  * "/script.js": JavaScript for the root page.
+     *  * "/style.css": CSS styles for the root page. Sent gzip-compressed.
+     *  * "/script.js": JavaScript for the root page. Sent gzip-compressed.
+     *
+     * The style sheet and script carry an `ETag` derived from their content at compile time, and `If-None-Match`
+     * requests for the current version receive a 304 response. The root page references them with a `v` parameter
+     * holding the version; such requests are marked as cacheable indefinitely.
      *  * "/settings/get": This path requires at least one parameter, the setting tab name. The values for that tab are returned as JSON.
      *     Example: "/settings/get?tab=Overview"
+     *     The parameter can be repeated, to return the values of several tabs in one response, or can be `all` for all tabs.
+     *     If `setting` parameters are included, only those settings are returned, from each tab.
+     *     Example: "/settings/get?tab=Overview&tab=WiFi"
+     *     If a `since` parameter is included, only settings changed after that version are returned. The response
+     *     has an `X-Settings-Version` header holding the version to use for the next request.
+     *  * "/settings/schema": A compact JSON description of all panels and settings, from which the browser constructs
+     *     the panels. It has an `ETag`, and changes only when panels are added.
+     *  * "/settings/events": A Server-Sent Events channel. Changed info setting values are sent as `values` events,
+     *     with the same JSON as "/settings/get"; see `set_event_interval` and `set_event_clients`.
      *  * "/settings/set": Handles POST of the form data from the main page. When all data has been transferred to the settings, the `on_save` callback is invoked.
+     *  * "/debug/heap": Heap use by the main page, "/settings/get" and "/settings/set", as JSON; only if enabled with `set_heap_debug`.
+     *  * "/metrics": Request metrics, in the Prometheus text format; only if enabled with `set_metrics`.
      *  * "/reboot": Call the `on_restart` callback. Performs no other action. Unprotected.
      *  * "/factoryreset": Call the `on_factory_reset` callback. Performs no other action. Unprotected.
      *  * "/upload": Show the upload page; this allows firmware uploads. Unprotected.
-     *  * "/upload": POST request; upload firmware. Unprotected.
+     *  * "/upload": POST request; upload firmware. Unprotected. An `md5` or `sha256` parameter, as a query
+     *    parameter or a form field before the file, gives the digest of the firmware; it is then verified before the
+     *    firmware is used.
      *
      * If the `on_restart` or `on_factory_reset` callbacks are not provided (i.e. are null), the associated URLs will
      * not be registered. The '/upload' URL will also not be registered if the `on_restart` callback is null.
      *
-     * The main page is written to storage (TinyFS) in the `setup` method, and served directly from storage thereafter.
-     * Sufficient storage must be available for the complete main page.
+     * By default, the main page is generated on every request, in chunks. Optionally, the page can be cached
+     * (see `set_page_cache`): it is then rendered once, from `loop`, and written gzip-compressed to LittleFS;
+     * requests are served directly from storage thereafter, with an `ETag` allowing browsers to revalidate
+     * cheaply. Adding a setting set invalidates the cache and it is re-rendered on the next `loop`.
+     * Sufficient storage must be available for the compressed main page.
+     *
+     * Only the first setting panel is included in the main page; the others are empty placeholders, and the browser
+     * constructs them from the schema when the tab is first opened. Each panel body includes a hidden marker field;
+     * when a POST contains any markers, only panels with markers are updated, so that panels never opened in the browser
+     * are not reset to their defaults.
      *
      * A 404 handler is also installed. When SoftAP mode is detected, this will return a 302 response redirecting
      * the page to the root page. This makes the server function as a captive portal in this mode. When the system
@@ -68,6 +98,15 @@ namespace grmcdorman
     public:
         typedef void (*notify_t)(WebSettings &);      //!< The callback definition.
 
+        //!< The settings in one panel that have changed.
+        struct PanelChanges
+        {
+            const __FlashStringHelper *identifier;          //!< The panel identifier.
+            SettingInterface::settings_list_t settings;     //!< The changed settings, in panel order.
+        };
+        typedef std::vector<PanelChanges> changes_t;                    //!< Changed settings, grouped by panel, in panel order.
+        typedef void (*notify_changes_t)(WebSettings &, const changes_t &);    //!< The callback definition for changes.
+
         /**
          * @brief Construct a new Web Server object.
          *
@@ -86,7 +125,8 @@ namespace grmcdorman
         /**
          * @brief Loop handling.
          *
-         * This presently does not do anything; it is provided for future use.
+         * This performs deferred work, such as rendering the page cache,
+         * refreshing info settings in the background, and pushing info setting values.
          *
          */
         void loop();
@@ -125,6 +165,275 @@ namespace grmcdorman
          */
         void add_setting_set(const __FlashStringHelper *name, const __FlashStringHelper *identifier, const SettingInterface::settings_list_t &setting_set);
 
+        /**
+         * @brief Set the callback for changes saved from the UI.
+         *
+         * This is called following handling a POST of /settings/set, after `on_save`,
+         * with the settings whose values were changed by the POST. Settings whose new value
+         * was the same as the old value are not included; if nothing changed, the list is empty.
+         * This allows the application to re-apply and persist only what has changed.
+         *
+         * Typically only one of this and `on_save` is provided.
+         *
+         * @param callback  Callback to invoke; null to not call.
+         */
+        void set_on_save_changes(notify_changes_t callback)
+        {
+            on_save_changes = callback;
+        }
+
+        /**
+         * @brief Get the settings changed after a version.
+         *
+         * Settings record the global version (`SettingInterface::get_current_version()`)
+         * of their last change; this collects settings, in all panels, with a later version.
+         *
+         * @param version   The version; settings changed after this are included.
+         * @return The changed settings, grouped by panel. Panels without changes are omitted.
+         */
+        changes_t get_changes_since(uint32_t version) const;
+
+        /**
+         * @brief Enable or disable the main page cache.
+         *
+         * When enabled, the main page is rendered once in `loop` (after `setup`, and again after
+         * any `add_setting_set`), stored gzip-compressed in LittleFS, and served from there.
+         * The file is only rewritten if the page content has changed. LittleFS must
+         * be mounted by the application. If the page cannot be written, the page is
+         * generated on every request as usual.
+         *
+         * The cached page records the values of settings at the time it was rendered; this
+         * has no visible effect, as values are always loaded by the page after it is shown.
+         *
+         * @param enable    `true` to enable the page cache.
+         */
+        void set_page_cache(bool enable)
+        {
+            page_cache_state = enable ? PageCacheState::STALE : PageCacheState::DISABLED;
+        }
+
+        /**
+         * @brief Set the interval for pushing info setting values.
+         *
+         * While any browser is connected to "/settings/events", `loop` samples the
+         * info settings at this interval, and sends the values that have changed to all
+         * connected browsers in a single event. The default is 5 seconds.
+         *
+         * @param interval  The interval, in milliseconds; 0 to disable sampling.
+         */
+        void set_event_interval(uint32_t interval)
+        {
+            event_interval = interval;
+        }
+
+        /**
+         * @brief Set the maximum number of browsers connected to "/settings/events".
+         *
+         * Each connection holds memory for as long as the browser is open. A browser is refused
+         * if this many are already connected, or if the largest free heap block is less than the
+         * `heap_reserve` given to `set_response_limits`, plus the cost of a response; a refused
+         * browser polls for values instead.
+         *
+         * @param max_clients   The maximum number of connected browsers; 0 to refuse all. The default is 2.
+         */
+        void set_event_clients(uint8_t max_clients)
+        {
+            event_client_limit = max_clients;
+        }
+
+        /**
+         * @brief Save the settings to a file.
+         *
+         * All settings with `is_persistable()` returning `true`, in all panels, are written
+         * in a compact binary form: each value is keyed by a hash of its panel identifier and
+         * name, and stored with its type. The file has a format version, and the values a CRC. It is written
+         * to a temporary file first (`path` with `.tmp` appended), and then renamed, so that the
+         * previous file is kept if writing fails.
+         *
+         * The file system must be mounted by the application.
+         *
+         * @param fs        The file system; e.g. `LittleFS`.
+         * @param path      The file path.
+         * @return `true` if the settings were saved.
+         */
+        bool save_settings(FS &fs, const String &path) const;
+
+        /**
+         * @brief Load the settings from a file.
+         *
+         * This reads a file written by `save_settings` or by the settings journal; no text parsing
+         * is done. Values for settings that are not in the file, and values in the file for settings that
+         * no longer exist or have changed type, are ignored. If the file has a different format version,
+         * no setting is changed. The file is read as a series of segments, each with a CRC; if a segment
+         * is damaged (e.g. by a power failure while it was appended), it and any later segments are ignored.
+         *
+         * Setting sets must be added before the settings are loaded.
+         *
+         * @param fs        The file system; e.g. `LittleFS`.
+         * @param path      The file path.
+         * @return `true` if the file was read.
+         */
+        bool load_settings(FS &fs, const String &path);
+
+        /**
+         * @brief Keep the settings in a journal file, written from `loop`.
+         *
+         * After a POST of /settings/set changes any setting, the save is deferred until no
+         * further change has been posted for `save_delay`; several saves in quick succession
+         * are written once. The changed persistable settings are then appended to the file
+         * from `loop`, rather than the whole file being rewritten from the request handler.
+         * Once the file reaches `compact_size`, it is rewritten with only the current values,
+         * as by `save_settings`; this is also done for the first save after this is called.
+         *
+         * The file is read with `load_settings`. Load the settings before calling this.
+         *
+         * The file system must be mounted by the application.
+         *
+         * @param fs            The file system; e.g. `LittleFS`.
+         * @param path          The file path.
+         * @param save_delay    The time to wait for further changes, in milliseconds.
+         * @param compact_size  The file size at which the file is rewritten.
+         */
+        void set_settings_journal(FS &fs, const String &path, uint32_t save_delay = 2000, size_t compact_size = 2048);
+
+        /**
+         * @brief Save to the journal after the save delay.
+         *
+         * This is done automatically after a POST of /settings/set; call this after changing
+         * settings in code. Does nothing if no journal is set.
+         */
+        void schedule_settings_save();
+
+        /**
+         * @brief Write a pending journal save immediately.
+         *
+         * Call this before restarting, so that a save that is still waiting for the
+         * save delay is not lost.
+         *
+         * @return `true` if there was nothing to save, or the save succeeded.
+         */
+        bool flush_settings_journal();
+
+        /**
+         * @brief Enable or disable the restart snapshot.
+         *
+         * When enabled, `save_restart_snapshot` is called on a GET of /reboot and after a
+         * successful firmware upload, before the `on_restart` callback.
+         *
+         * @param enable    `true` to take a snapshot before a requested restart.
+         */
+        void set_restart_snapshot(bool enable)
+        {
+            restart_snapshot = enable;
+        }
+
+        /**
+         * @brief Save the persistable settings in RTC memory, for use after a restart.
+         *
+         * RTC user memory is kept across `ESP.restart()`. The values are stored in the same form
+         * as `save_settings`, with a CRC, after the area used by OTA updates; 368 bytes are available
+         * for the values. If they do not fit, no snapshot is kept.
+         *
+         * @return `true` if the snapshot was saved.
+         */
+        bool save_restart_snapshot() const;
+
+        /**
+         * @brief Restore the settings from a restart snapshot.
+         *
+         * Call this at startup, after adding the setting sets. The snapshot is only used after
+         * a software restart, and only once; if it is restored, there is no need to
+         * load the settings from the file system.
+         *
+         * @return `true` if the settings were restored.
+         */
+        bool restore_restart_snapshot();
+
+        /**
+         * @brief Enable or disable heap instrumentation.
+         *
+         * When enabled, the free heap and the largest free block are recorded at the start and end of
+         * requests for "/", "/settings/get" and "/settings/set", and the lowest values seen while
+         * their responses are sent. These are available as JSON at "/debug/heap". This
+         * is useful to size setting panels, and to find regressions when settings are added.
+         *
+         * Call this before `setup`; the "/debug/heap" URL is only registered if this is enabled. It is not protected.
+         *
+         * @param enable    `true` to record heap use.
+         */
+        void set_heap_debug(bool enable)
+        {
+            heap_debug = enable;
+        }
+
+        /**
+         * @brief Enable or disable request metrics.
+         *
+         * When enabled, the requests for each URL registered by `setup` are counted, with their
+         * responses by status class, response body bytes, chunks for chunked responses, and a histogram
+         * of the time until the response is complete. Authentication challenges and firmware upload
+         * bytes and time are also counted. The metrics are served in the Prometheus text format
+         * at "/metrics". This uses about 1K of memory.
+         *
+         * Call this before `setup`; the "/metrics" URL is only registered if this is enabled. It is not protected.
+         * If metrics are disabled after `setup`, "/metrics" responds as an unknown URL.
+         *
+         * @param enable    `true` to record metrics.
+         */
+        void set_metrics(bool enable)
+        {
+            metrics.reset(enable ? new Metrics() : nullptr);
+        }
+
+        /**
+         * @brief Set the limits on starting responses.
+         *
+         * The main page, "/settings/get" and "/settings/schema" responses hold memory until
+         * they have been sent. Each is given one of `max_responses` slots, which holds its
+         * context, until it completes or the client disconnects; and one is only started if the
+         * largest free heap block exceeds its estimated size by `heap_reserve`. The style sheet and
+         * script are only checked against the heap. Other requests receive a 503 (Service Unavailable)
+         * response with a `Retry-After` header, which the page script honours, instead of risking
+         * running out of memory. Requests refused because all slots are in use are counted; see
+         * `get_response_slots_exhausted`.
+         *
+         * Call this before `setup`. Each slot uses about 64 bytes.
+         *
+         * @param max_responses     The number of response slots; at least 1. The default is 3.
+         * @param heap_reserve      The free heap to keep, in bytes. The default is 4096.
+         */
+        void set_response_limits(uint8_t max_responses, size_t heap_reserve)
+        {
+            response_limit = std::max<uint8_t>(max_responses, 1);
+            response_slots.reset(new ResponseSlot[response_limit]);
+            response_heap_reserve = heap_reserve;
+        }
+
+        /**
+         * @brief Set the number of buffers for firmware uploads.
+         *
+         * Uploaded firmware is collected in buffers of one flash sector (4K), which are written
+         * to flash from `loop`, rather than as the data arrives; this keeps flash erases from
+         * stalling the connection. If all the buffers are full, or they cannot be allocated,
+         * data is written as it arrives. The buffers are only allocated during an upload.
+         *
+         * @param count     The number of buffers; fewer than 2 to write data as it arrives. The default is 2.
+         */
+        void set_upload_buffers(uint8_t count)
+        {
+            upload_buffer_count = count;
+        }
+
+        /**
+         * @brief Get the number of requests refused because all response slots were in use.
+         *
+         * @return The number of requests refused; see `set_response_limits`.
+         */
+        uint32_t get_response_slots_exhausted() const
+        {
+            return response_slots_exhausted;
+        }
+
         /**
          * @brief Get the server.
          *
@@ -159,11 +468,15 @@ namespace grmcdorman
             generate_new_authentication();
         }
     private:
-        typedef std::list<std::unique_ptr<SettingPanel>> setting_panel_list_t;
+        typedef std::vector<SettingPanel> setting_panel_list_t;
 
         void on_not_found(AsyncWebServerRequest *request);          //!< Handle page not found; either 404 or 302 redirect, depending on SoftAP mode.
         void on_request_values(AsyncWebServerRequest *request);     //!< Handle a request for values.
-        void on_request_upload(AsyncWebServerRequest *request);     //!< Handle a request to upload firmware. Presents a page to allow a file upload.
+        void on_request_schema(AsyncWebServerRequest *request);     //!< Handle a request for the setting schema.
+        int find_panel(const String &identifier) const;             //!< Find a panel's position by identifier; -1 if there is none.
+        void on_post_settings(AsyncWebServerRequest *request);     //!< Apply a POST of the form data to the settings.
+        void build_field_index();                                   //!< Rebuild `field_index` from the setting panels.
+        size_t on_request_upload(AsyncWebServerRequest *request);   //!< Handle a request to upload firmware. Presents a page to allow a file upload; returns its size.
 
         /**
          * @brief Handle upload of a firmware file segment.
@@ -185,8 +498,40 @@ namespace grmcdorman
          * This sends an upload failure response via the request. This is a 500 status response.
          *
          * @param request   The upload request.
+         * @param reason    The reason for the failure; if null, the update error code is shown.
+         */
+        void on_update_failed(AsyncWebServerRequest *request, const __FlashStringHelper *reason = nullptr);
+
+        /**
+         * @brief Abandon the firmware upload after a failure.
+         *
+         * This sends the failure response, and discards the update; the firmware is not used.
+         *
+         * @param request   The upload request.
+         * @param reason    The reason for the failure; if null, the update error code is shown.
+         */
+        void fail_upload(AsyncWebServerRequest *request, const __FlashStringHelper *reason = nullptr);
+
+        /**
+         * @brief Start a firmware upload.
+         *
+         * @param request   The upload request.
+         * @return `true` if the upload was started; otherwise, the failure response has been sent.
+         */
+        bool start_upload(AsyncWebServerRequest *request);
+
+        /**
+         * @brief Add uploaded firmware to the buffers, writing data to flash where it does not fit.
+         *
+         * @param data      The data.
+         * @param len       The length of the data.
+         * @return `true` if successful; `false` if a write to flash failed.
          */
-        void on_update_failed(AsyncWebServerRequest *request);
+        bool buffer_upload(const uint8_t *data, size_t len);
+
+        //!< Write the oldest full upload buffer to flash; returns `false` if the write failed.
+        bool write_upload_buffer();
+
         /**
          * @brief Handle the upload successful completion.
          *
@@ -196,27 +541,317 @@ namespace grmcdorman
          */
         void on_update_done(AsyncWebServerRequest *request);
 
+        //!< An entry in the index of form field names.
+        struct FieldIndexEntry
+        {
+            uint32_t hash;                  //!< The hash of the field name, `identifier$name` for a setting or `identifier$` for a panel marker.
+            SettingInterface *setting;      //!< The setting; null for a panel marker.
+            uint16_t panel;                 //!< The panel's position in `setting_panels`.
+            uint16_t position;              //!< For a setting, its position in registration order across all panels.
+        };
+
+        //!< Heap use recorded for one kind of request.
+        struct HeapUsage
+        {
+            uint32_t requests = 0;              //!< The number of requests.
+            uint32_t free_before = 0;           //!< The free heap at the start of the last request.
+            uint32_t free_after = 0;            //!< The free heap at the end of the last request.
+            uint32_t free_low = UINT32_MAX;     //!< The lowest free heap during any request.
+            uint32_t block_before = 0;          //!< The largest free block at the start of the last request.
+            uint32_t block_after = 0;           //!< The largest free block at the end of the last request.
+            uint32_t block_low = UINT32_MAX;    //!< The smallest largest free block during any request.
+        };
+
+        void heap_request_start(HeapUsage &usage);                  //!< If heap instrumentation is enabled, record the start of a request.
+        void heap_request_sample(HeapUsage &usage);                 //!< If heap instrumentation is enabled, update the lowest values during a request.
+        void heap_request_end(HeapUsage &usage);                    //!< If heap instrumentation is enabled, record the end of a request.
+        void on_request_heap(AsyncWebServerRequest *request);       //!< Handle a request for the heap instrumentation.
+
+        //!< The URLs for which metrics are recorded.
+        enum class MetricsEndpoint {
+            MAIN_PAGE,          //!< GET "/".
+            STYLE_CSS,          //!< GET "/style.css".
+            SCRIPT_JS,          //!< GET "/script.js".
+            SETTINGS_SET,       //!< POST "/settings/set".
+            SETTINGS_GET,       //!< GET "/settings/get".
+            SETTINGS_SCHEMA,    //!< GET "/settings/schema".
+            REBOOT,             //!< GET "/reboot".
+            FACTORY_RESET,      //!< GET "/factoryreset".
+            UPLOAD_PAGE,        //!< GET "/upload".
+            UPLOAD,             //!< POST "/upload".
+            COUNT               //!< The number of endpoints.
+        };
+
+        static constexpr size_t METRICS_LATENCY_BUCKETS = 10;   //!< The number of latency histogram buckets, including the unbounded bucket.
+
+        //!< Metrics for one URL.
+        struct EndpointMetrics
+        {
+            uint32_t requests;                              //!< Requests received.
+            uint32_t responses[4];                          //!< Responses sent, by status class: 2xx, 3xx, 4xx, and 5xx.
+            uint32_t bytes;                                 //!< Response body bytes.
+            uint32_t chunks;                                //!< Chunks of chunked responses.
+            uint32_t latency[METRICS_LATENCY_BUCKETS];      //!< Responses, by latency bucket; not cumulative.
+            uint64_t latency_sum;                           //!< The total latency, in microseconds.
+        };
+
+        //!< Request metrics.
+        struct Metrics
+        {
+            EndpointMetrics endpoints[static_cast<size_t>(MetricsEndpoint::COUNT)];    //!< Metrics for each URL.
+            uint32_t auth_challenges;                       //!< Authentication challenges sent.
+            uint32_t upload_bytes;                          //!< Firmware bytes uploaded.
+            uint32_t upload_time;                           //!< Time spent receiving completed uploads, in milliseconds.
+            uint32_t upload_start;                          //!< The `micros()` time at which the current upload started.
+            uint32_t slots_exhausted;                       //!< Requests refused for lack of a response slot; only set when copied for sending.
+        };
+
+        //!< This structure holds tracking context for sending metrics.
+        struct MetricsChunkContext
+        {
+            Metrics metrics;                    //!< The metrics to send; copied when requested, so that they do not change while sent.
+            size_t family = 0;                  //!< The metric family being sent.
+            size_t line = 0;                    //!< The line in the family being sent.
+            size_t fragment_offset = 0;         //!< For the current line, size sent so far.
+        };
+
+        /**
+         * @brief Count a request, if metrics are enabled.
+         *
+         * @param endpoint  The URL requested.
+         * @return The `micros()` time at the start of the request; pass this to `metrics_response`.
+         */
+        uint32_t metrics_request(MetricsEndpoint endpoint);
+
+        /**
+         * @brief Count a chunk of a chunked response, if metrics are enabled.
+         *
+         * @param endpoint  The URL requested.
+         * @param size      The size of the chunk; the empty chunk that ends the response is not counted.
+         */
+        void metrics_chunk(MetricsEndpoint endpoint, size_t size);
+
+        /**
+         * @brief Count a completed response, if metrics are enabled.
+         *
+         * @param endpoint  The URL requested.
+         * @param start     The time returned by `metrics_request`.
+         * @param code      The HTTP status code.
+         * @param bytes     The response body bytes; 0 for chunked responses, which count their chunks.
+         */
+        void metrics_response(MetricsEndpoint endpoint, uint32_t start, int code, size_t bytes);
+
+        void metrics_upload_response(int code, size_t bytes);       //!< If metrics are enabled, count the response to a firmware upload.
+        void on_request_metrics(AsyncWebServerRequest *request);    //!< Handle a request for the metrics.
+
+        /**
+         * @brief Handle metrics chunks.
+         *
+         * @param buffer[in,out]    Buffer to receive output data.
+         * @param maxLine           Maximum capacity of `buffer`.
+         * @param context           Context for sending chunks.
+         * @return Size of the chunk; zero when all metrics have been sent.
+         */
+        static size_t on_metrics_chunk(uint8_t *buffer, size_t maxLen, MetricsChunkContext &context);
+
+        /**
+         * @brief Write one line of the metrics.
+         *
+         * @param writer    The destination.
+         * @param metrics   The metrics.
+         * @param family    The metric family.
+         * @param line      The line within the family.
+         * @return `false` if the family has no such line; nothing is written.
+         */
+        static bool write_metrics_line(HtmlWriter &writer, const Metrics &metrics, size_t family, size_t line);
+
+        /**
+         * @brief Decide whether to start a response.
+         *
+         * If the response is refused, a 503 response is sent, and counted in the metrics.
+         * If it is admitted and `needs_slot`, it holds a response slot until `release_response`
+         * is called for it, which is done when the client disconnects if not before.
+         *
+         * @param request       The request.
+         * @param endpoint      The URL requested.
+         * @param start         The time returned by `metrics_request`.
+         * @param size          The estimated size of the response body; see `response_size_estimate`.
+         * @param needs_slot    If `true`, the response needs a response slot.
+         * @return `true` if the response can be sent.
+         */
+        bool admit_response(AsyncWebServerRequest *request, MetricsEndpoint endpoint, uint32_t start, size_t size, bool needs_slot);
+
+        /**
+         * @brief Estimate the size of a response body, for `admit_response`.
+         *
+         * Only a send buffer of a response is held at a time, so the estimate matters for
+         * responses smaller than that: the style sheet, and the JSON for few settings.
+         *
+         * @param endpoint      The URL requested.
+         * @return The estimated size; the actual size for a cached main page and the assets.
+         */
+        size_t response_size_estimate(MetricsEndpoint endpoint) const;
+
+        /**
+         * @brief Create the context for a response, in its slot.
+         *
+         * @tparam T        The context type.
+         * @param request   The request; it must have been given a slot by `admit_response`.
+         * @return The context; it is destroyed by `release_response`.
+         */
+        template<typename T>
+        T *create_context(AsyncWebServerRequest *request);
+
+        //!< Destroy the context of a response, if any, and free its slot. Does nothing if the request has no slot.
+        void release_response(AsyncWebServerRequest *request);
+
+        /**
+         * @brief Release what is held for a request when its connection closes.
+         *
+         * This frees its response slot, and abandons the firmware upload it is sending. The server keeps
+         * one disconnect handler per request, so this is the only one registered.
+         *
+         * @param request   The request.
+         */
+        void on_request_disconnect(AsyncWebServerRequest *request);
+
+        //!< Find the first `field_index` entry with a hash; the end if there is none.
+        std::vector<FieldIndexEntry>::const_iterator find_field(uint32_t hash) const;
+
+        /**
+         * @brief Write a segment of setting records to a settings file.
+         *
+         * The segment holds the persistable settings; all of them, or only those changed
+         * after a version. Nothing is written if there are no such settings.
+         *
+         * @param output    The destination; e.g. a file, positioned at the end.
+         * @param all       If `true`, all persistable settings are written.
+         * @param since     If `all` is `false`, only settings changed after this version are written.
+         * @return `true` if the segment was written.
+         */
+        bool write_settings_segment(Print &output, bool all, uint32_t since) const;
+
+        /**
+         * @brief Apply the records in a settings file segment.
+         *
+         * @param read      Reads the next part of the records; returns `false` on failure.
+         * @param length    The length of the records.
+         * @return `true` if all records were read.
+         */
+        bool apply_settings_segment(const std::function<bool(uint8_t *, size_t)> &read, uint32_t length);
+
+        //!< States for the main page cache.
+        enum class PageCacheState {
+            DISABLED,           //!< The page cache is not in use.
+            STALE,              //!< The page cache must be rendered.
+            VALID,              //!< The page cache is up to date.
+            FAILED              //!< The page cache could not be rendered.
+        };
+
         //!< States for the main page chunk transmission.
         enum class MainPageChunkState {
-            BEGIN_PAGE,         //!< Sending the initial portion.
-            STYLE_SHEET,        //!< Sending the style sheet body.
-            PRE_JAVASCRIPT,     //!< Closing off the style sheet, starting JavaScript.
-            JAVASCRIPT,         //!< Sending the javascript.
-            POST_JAVASCRIPT,    //!< Sending post-javascript up to the tab button header.
+            BEGIN_PAGE,         //!< Sending the initial portion, up to the tab button header.
             TABBUTTON_HEADER,   //!< Sending the tab button header.
             TAB_BODY,           //!< Sending the tab bodies.
             FOOTER,             //!< Sending the footer.
             DONE                //!< Completed seting.
         };
 
+        //!< States for the panel body chunk transmission.
+        enum class PanelBodyChunkState {
+            MARKER,             //!< Sending the hidden field marking the panel as present.
+            SETTINGS,           //!< Sending the settings.
+            END,                //!< Sending the end of the panel body.
+            DONE                //!< Completed panel body.
+        };
+
+        //!< This structure holds tracking context for sending a panel body.
+        struct PanelBodyChunkContext
+        {
+            PanelBodyChunkState state = PanelBodyChunkState::MARKER;            //!< The current state.
+            SettingInterface::settings_list_t::const_iterator current_setting;  //!< Where applicable, the setting being processed.
+            size_t fragment_offset = 0;                                         //!< For the current piece, size of its HTML sent so far.
+        };
+
         //!< This structure holds tracking context for sending the main page.
         struct MainPageChunkContext
         {
             MainPageChunkState state = MainPageChunkState::BEGIN_PAGE;          //!< The current state.
-            setting_panel_list_t::const_iterator current_panel;                 //!< Where applicable, the panel being processed.
-            SettingInterface::settings_list_t::const_iterator current_setting;  //!< Where applicable, the setting in the panel being processed.
+            size_t current_panel = 0;                                           //!< Where applicable, the position of the panel being processed.
             bool starting_tab = true;                                           //!< If `true`, a tab body is to be started.
-            size_t sent_static_size = 0;                                        //!< For the style sheet and javascript, size sent so far.
+            size_t fragment_offset = 0;                                         //!< For the current piece, size of its HTML sent so far.
+            PanelBodyChunkContext panel_body;                                   //!< For the current panel, the body state.
+        };
+
+        //!< States for the schema chunk transmission.
+        enum class SchemaChunkState {
+            BEGIN,              //!< Sending the start of the panel array.
+            PANEL_START,        //!< Sending the panel identifier and name.
+            SETTINGS,           //!< Sending the panel's settings.
+            PANEL_END,          //!< Sending the end of the panel.
+            END,                //!< Sending the end of the panel array.
+            DONE                //!< Completed schema.
+        };
+
+        //!< This structure holds tracking context for sending the schema.
+        struct SchemaChunkContext
+        {
+            SchemaChunkState state = SchemaChunkState::BEGIN;                   //!< The current state.
+            size_t current_panel = 0;                                           //!< Where applicable, the position of the panel being processed.
+            SettingInterface::settings_list_t::const_iterator current_setting;  //!< Where applicable, the setting being processed.
+            size_t fragment_offset = 0;                                         //!< For the current piece, size of its JSON sent so far.
+        };
+
+        //!< States for the values chunk transmission.
+        enum class ValuesChunkState {
+            BEGIN,              //!< Sending the start of the object.
+            PANEL_START,        //!< Sending the panel identifier.
+            SETTINGS,           //!< Sending the panel's values.
+            PANEL_END,          //!< Sending the end of the panel.
+            END,                //!< Sending the end of the object.
+            DONE                //!< Completed values.
+        };
+
+        //!< This structure holds tracking context for sending values.
+        struct ValuesChunkContext
+        {
+            ValuesChunkState state = ValuesChunkState::BEGIN;                   //!< The current state.
+            std::vector<uint16_t> panels;                                       //!< The positions of the panels to send.
+            SettingPanel::requested_settings_t requested_settings;              //!< The settings to send; empty for all.
+            size_t current_panel = 0;                                           //!< Where applicable, the index in `panels` of the panel being processed.
+            SettingInterface::settings_list_t::const_iterator current_setting;  //!< Where applicable, the setting being processed.
+            bool first_value = true;                                            //!< If `true`, no value has been sent for the current panel.
+            bool value_prepared = false;                                        //!< If `true`, the current setting's value has been prepared.
+            bool has_since = false;                                             //!< If `true`, only settings changed after `since` are sent.
+            uint32_t since = 0;                                                 //!< The version from the `since` parameter.
+            size_t fragment_offset = 0;                                         //!< For the current piece, size of its JSON sent so far.
+        };
+
+        //!< This structure holds the state of a firmware upload.
+        struct UploadContext
+        {
+            AsyncWebServerRequest *request = nullptr;           //!< The upload request.
+            std::vector<std::unique_ptr<uint8_t[]>> buffers;    //!< The sector buffers, used in turn; empty if data is written as it arrives.
+            size_t write_index = 0;                             //!< The position in `buffers` of the next full buffer to write.
+            volatile size_t full_count = 0;                     //!< The number of full buffers waiting to be written.
+            size_t fill_size = 0;                               //!< The amount of data in the buffer being filled.
+            volatile bool writing = false;                      //!< Set while `loop` writes a buffer.
+            volatile bool failed = false;                       //!< Set when `loop` fails to write a buffer.
+            bool check_sha256 = false;                          //!< Set if the firmware SHA-256 digest is verified.
+            uint8_t sha256[br_sha256_SIZE];                     //!< The expected SHA-256 digest.
+            br_sha256_context sha256_context;                   //!< The SHA-256 digest of the data received.
+        };
+
+        //!< The size of the largest response context.
+        static constexpr size_t response_context_size = std::max({ sizeof(MainPageChunkContext), sizeof(SchemaChunkContext),
+            sizeof(ValuesChunkContext) });
+
+        //!< A response slot: a place for a response being sent, with storage for its context.
+        struct ResponseSlot
+        {
+            AsyncWebServerRequest *request = nullptr;               //!< The request using the slot; null if it is free.
+            void (*destroy)(void *context) = nullptr;               //!< Destroys the context in `storage`; null if there is none.
+            alignas(std::max_align_t) uint8_t storage[response_context_size];  //!< Storage for the context.
         };
 
        /**
@@ -235,7 +870,8 @@ namespace grmcdorman
         /**
          * @brief Handle a main page tab button chunk.
          *
-         * This writes as a many complete tab buttons as possible to the buffer.
+         * This writes as much of the tab buttons to the buffer as will fit; a button
+         * that does not fit is continued in the next chunk.
          * When it returns `true`, processing can move to the next state.
          *
          * @param buffer[in,out]    Buffer to receive output data.
@@ -249,8 +885,9 @@ namespace grmcdorman
         /**
          * @brief Handle a main page tab body chunk.
          *
-         * This writes as a many complete tab bodies to the buffer. It
-         * does so at a granularity of individual settings within the setting tab.
+         * This writes as much of the tab bodies to the buffer as will fit. Setting
+         * HTML is written directly to the buffer; a setting, or the start or end of
+         * a tab, that does not fit is continued in the next chunk.
          * When it returns `true`, processing can move to the next state.
          *
          * @param buffer[in,out]    Buffer to receive output data.
@@ -261,10 +898,54 @@ namespace grmcdorman
          */
         bool on_main_page_tabbody_chunk(uint8_t *buffer, size_t maxLen, size_t &size, MainPageChunkContext &context);
 
+        /**
+         * @brief Handle a panel body chunk.
+         *
+         * This writes as much of the panel body - a hidden marker field, the settings,
+         * and a closing element - as will fit. It is used both for the main page and
+         * for panels requested individually.
+         * When it returns `true`, the panel body is complete.
+         *
+         * @param buffer[in,out]    Buffer to receive output data.
+         * @param maxLine           Maximum capacity of `buffer`.
+         * @param size              Current used buffer capacity.
+         * @param panel             The panel being written.
+         * @param context           Context for sending the panel body.
+         * @return `true` if the panel body has been written to the buffer.
+         */
+        bool on_panel_body_chunk(uint8_t *buffer, size_t maxLen, size_t &size, const SettingPanel &panel, PanelBodyChunkContext &context);
+
+        /**
+         * @brief Handle schema chunks.
+         *
+         * This writes as much of the schema as will fit in the buffer.
+         *
+         * @param buffer[in,out]    Buffer to receive output data.
+         * @param maxLine           Maximum capacity of `buffer`.
+         * @param context           Context for sending chunks.
+         * @return Size of the chunk; zero when the schema is complete.
+         */
+        size_t on_schema_chunk(uint8_t *buffer, size_t maxLen, SchemaChunkContext &context);
+
+        /**
+         * @brief Handle values chunks.
+         *
+         * This writes as much of the requested values as will fit in the buffer.
+         * Values are written directly to the buffer; a value that does not fit
+         * is continued in the next chunk.
+         *
+         * @param buffer[in,out]    Buffer to receive output data.
+         * @param maxLine           Maximum capacity of `buffer`.
+         * @param context           Context for sending chunks.
+         * @return Size of the chunk; zero when all values have been sent.
+         */
+        size_t on_values_chunk(uint8_t *buffer, size_t maxLen, ValuesChunkContext &context);
+
         /**
          * @brief Handle the main page footer chunk.
          *
-         * Unlike other processing, this requires all footer to fit in the buffer.
+         * This writes as much of the footer as will fit; the rest is continued
+         * in the next chunk.
          * It will return `true` if all data has been written, and `false` otherwise.
          *
          * @param buffer[in,out]    Buffer to receive output data.
@@ -275,6 +956,55 @@ namespace grmcdorman
          */
         bool on_main_page_footer_chunk(uint8_t *buffer, size_t maxLen, size_t &size, MainPageChunkContext &context);
 
+        /**
+         * @brief Render the complete main page.
+         *
+         * This runs the main page chunk processing to completion, passing each chunk
+         * to the consumer.
+         *
+         * @param consumer  Receives each chunk of the page.
+         * @return `true` if the complete page was rendered.
+         */
+        bool render_main_page(const std::function<void(const uint8_t *, size_t)> &consumer);
+
+        /**
+         * @brief Render the page cache to storage.
+         *
+         * The file is only written if the content has changed. On failure, the cache
+         * is not used until it is next invalidated.
+         */
+        void update_page_cache();
+
+        /**
+         * @brief Send the main page from the page cache.
+         *
+         * A 304 response is sent if the browser already has the current page.
+         *
+         * @param request   The request for the main page.
+         * @param start     The time returned by `metrics_request` for the request.
+         * @return `true` if a response was sent; `false` if the page cache is not available.
+         */
+        bool send_page_cache(AsyncWebServerRequest *request, uint32_t start);
+
+        /**
+         * @brief Mark the page cache as needing to be rendered, if it is enabled.
+         */
+        void invalidate_page_cache()
+        {
+            if (page_cache_state != PageCacheState::DISABLED)
+            {
+                page_cache_state = PageCacheState::STALE;
+            }
+        }
+
+        /**
+         * @brief Sample the dynamic settings, and send changed values to event clients.
+         *
+         * Settings are changed if their version is later than the last sample. The values
+         * are serialized once, in a single event, for all clients.
+         */
+        void send_events();
+
         /**
          * @brief Verify request authentication, if enabled.
          *
@@ -294,15 +1024,55 @@ namespace grmcdorman
         notify_t on_save;           //!< The on-save callback. Can be null.
         notify_t on_restart;        //!< The on restart callback. Can be null.
         notify_t on_factory_reset;  //!< The on factory reset callback. Can be null.
+        notify_changes_t on_save_changes;   //!< The on-save callback with changed settings. Can be null.
 
         AsyncWebServer server;      //!< The web server.
+        AsyncEventSource events;    //!< The "/settings/events" channel.
 
-        setting_panel_list_t setting_panels;    //!< The setting panels.
+        setting_panel_list_t setting_panels;        //!< The setting panels, in registration order.
+        std::vector<FieldIndexEntry> field_index;   //!< Form field names for all panels and settings, sorted by hash; used for POST requests and panel lookup.
+        size_t field_setting_count;                 //!< The number of settings in `field_index`.
 
         String auth_user;           //!< The authentication name.
         String auth_password;       //!< The authentication password.
         char auth_realm[17];        //!< Set to a random string in the constructor, and after every successfull authentication.
         String last_auth_digest;    //!< Last authentication digest. Generated whenever auth_realm changes.
 
+        bool is_setup;                      //!< Set when `setup` has been called.
+        PageCacheState page_cache_state;    //!< The main page cache state.
+        char page_cache_etag[11];           //!< The quoted ETag for the page cache; the content CRC in hex.
+        size_t page_cache_size;             //!< The size of the page cache file.
+        char schema_etag[11];               //!< The quoted ETag for the schema; empty until computed.
+        uint32_t event_interval;            //!< The interval between event samples, in milliseconds; 0 if disabled.
+        uint32_t last_event_sample;         //!< The `millis()` time of the last event sample.
+        volatile bool events_resend;        //!< Set when all values must be sent in the next event.
+        uint32_t event_version;             //!< The setting version at the last event sample.
+        uint8_t event_client_limit;         //!< The maximum number of connected event clients.
+
+        FS *journal_fs;                     //!< The file system for the settings journal; null if there is none.
+        String journal_path;                //!< The settings journal path.
+        uint32_t journal_delay;             //!< The time to wait for further changes before saving, in milliseconds.
+        size_t journal_compact_size;        //!< The journal size at which it is rewritten.
+        uint32_t journal_version;           //!< The setting version at the last journal save.
+        uint32_t journal_change_time;       //!< The `millis()` time of the last scheduled save.
+        volatile bool journal_pending;      //!< Set when a journal save is scheduled.
+        bool journal_compact;               //!< Set when the journal must be rewritten on the next save.
+        bool restart_snapshot;              //!< Set when a snapshot is saved before a requested restart.
+
+        bool heap_debug;                    //!< Set when heap use is recorded.
+        HeapUsage main_page_heap;           //!< Heap use for "/".
+        HeapUsage values_heap;              //!< Heap use for "/settings/get".
+        HeapUsage post_heap;                //!< Heap use for "/settings/set".
+
+        std::unique_ptr<Metrics> metrics;   //!< Request metrics; null unless enabled.
+
+        uint8_t response_limit;             //!< The number of response slots.
+        std::unique_ptr<ResponseSlot[]> response_slots;     //!< The response slots.
+        size_t response_heap_reserve;       //!< The free heap to keep when starting a response.
+        uint32_t response_slots_exhausted;  //!< The number of requests refused because all response slots were in use.
+
+        uint8_t upload_buffer_count;        //!< The number of buffers to use for a firmware upload.
+        std::unique_ptr<UploadContext> upload;  //!< The firmware upload in progress; null if there is none.
+
     };
 }
\ No newline at end of file
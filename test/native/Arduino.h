@@ -0,0 +1,140 @@
+#pragma once
+
+// Host stand-in for the parts of the ESP8266 Arduino core used by the library, for the
+// native PlatformIO environment. Time is real; `delay` returns at once.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "pgmspace.h"
+#include "WString.h"
+
+#define FLASH_SECTOR_SIZE 4096
+
+inline unsigned long micros()
+{
+    using namespace std::chrono;
+    static const steady_clock::time_point start = steady_clock::now();
+    return duration_cast<microseconds>(steady_clock::now() - start).count();
+}
+inline unsigned long millis() { return micros() / 1000; }
+inline void delay(unsigned long) {}
+inline void yield() {}
+inline long random(long low, long high) { return low + rand() % (high - low); }
+
+inline char *itoa(int value, char *buffer, int) { sprintf(buffer, "%d", value); return buffer; }
+inline char *utoa(unsigned value, char *buffer, int) { sprintf(buffer, "%u", value); return buffer; }
+inline char *ltoa(long value, char *buffer, int) { sprintf(buffer, "%ld", value); return buffer; }
+inline char *ultoa(unsigned long value, char *buffer, int) { sprintf(buffer, "%lu", value); return buffer; }
+inline char *dtostrf(double value, signed char width, unsigned char precision, char *buffer)
+{
+    sprintf(buffer, "%*.*f", width, precision, value);
+    return buffer;
+}
+
+class Print
+{
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t ch) = 0;
+    virtual size_t write(const uint8_t *data, size_t length)
+    {
+        size_t written = 0;
+        while (written < length && write(data[written]) == 1)
+        {
+            ++written;
+        }
+        return written;
+    }
+    size_t print(const String &text) { return write(reinterpret_cast<const uint8_t *>(text.c_str()), text.length()); }
+    size_t print(const char *text) { return write(reinterpret_cast<const uint8_t *>(text), strlen(text)); }
+};
+
+class Stream: public Print
+{
+public:
+    virtual int available() { return 0; }
+    virtual int read() { return -1; }
+    virtual int peek() { return -1; }
+    size_t readBytes(uint8_t *data, size_t length)
+    {
+        size_t count = 0;
+        int ch;
+        while (count < length && (ch = read()) >= 0)
+        {
+            data[count++] = static_cast<uint8_t>(ch);
+        }
+        return count;
+    }
+    size_t readBytes(char *data, size_t length) { return readBytes(reinterpret_cast<uint8_t *>(data), length); }
+};
+
+struct rst_info;
+
+//!< The ESP object; the heap figures can be set to test low memory handling.
+class EspClass
+{
+public:
+    uint32_t getFreeHeap() { return free_heap; }
+    uint32_t getMaxFreeBlockSize() { return max_free_block; }
+    uint8_t getHeapFragmentation() { return 0; }
+    uint32_t getFreeSketchSpace() { return 0x100000; }
+    uint32_t getFlashChipSize() { return 0x400000; }
+    uint32_t getChipId() { return 0; }
+    rst_info *getResetInfoPtr() { return reset_info; }
+    bool rtcUserMemoryRead(uint32_t offset, uint32_t *data, size_t size)
+    {
+        if (offset * 4 + size > sizeof(rtc_memory))
+        {
+            return false;
+        }
+        memcpy(data, reinterpret_cast<uint8_t *>(rtc_memory) + offset * 4, size);
+        return true;
+    }
+    bool rtcUserMemoryWrite(uint32_t offset, uint32_t *data, size_t size)
+    {
+        if (offset * 4 + size > sizeof(rtc_memory))
+        {
+            return false;
+        }
+        memcpy(reinterpret_cast<uint8_t *>(rtc_memory) + offset * 4, data, size);
+        return true;
+    }
+    bool eraseConfig() { return true; }
+    void restart() {}
+    void reset() {}
+
+    uint32_t free_heap = 40000;
+    uint32_t max_free_block = 30000;
+    rst_info *reset_info = nullptr;
+    uint32_t rtc_memory[128] = {};
+};
+inline EspClass ESP;
+
+//!< The firmware updater; the data written is kept, for tests.
+class UpdaterClass
+{
+public:
+    void runAsync(bool) {}
+    bool begin(size_t) { data.clear(); return true; }
+    bool setMD5(const char *md5) { return strlen(md5) == 32; }
+    size_t write(uint8_t *buffer, size_t length)
+    {
+        data.insert(data.end(), buffer, buffer + length);
+        return length;
+    }
+    bool end(bool commit = false) { committed = commit; return true; }
+    uint8_t getError() { return 0; }
+    bool hasError() { return false; }
+
+    std::vector<uint8_t> data;
+    bool committed = false;
+};
+inline UpdaterClass Update;
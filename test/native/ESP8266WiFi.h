@@ -0,0 +1,12 @@
+#pragma once
+
+#include "Arduino.h"
+#include "IPAddress.h"
+
+class WiFiClass
+{
+public:
+    IPAddress softAPIP() { return IPAddress(0x0104a8c0); }
+    uint8_t softAPgetStationNum() { return 0; }
+};
+inline WiFiClass WiFi;
@@ -0,0 +1,404 @@
+#pragma once
+
+// Host stand-in for ESPAsyncWebServer. Handlers registered with `on` are kept, and
+// `AsyncWebServer::handle` runs the one for a request. The response sent is kept by the
+// request; a chunked response is produced by calling its filler (see `read_chunk`).
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "Arduino.h"
+#include "ESP8266WiFi.h"
+#include "FS.h"
+
+typedef enum
+{
+    HTTP_GET     = 0b00000001,
+    HTTP_POST    = 0b00000010,
+    HTTP_DELETE  = 0b00000100,
+    HTTP_PUT     = 0b00001000,
+    HTTP_PATCH   = 0b00010000,
+    HTTP_HEAD    = 0b00100000,
+    HTTP_OPTIONS = 0b01000000,
+    HTTP_ANY     = 0b01111111,
+} WebRequestMethod;
+
+class AsyncWebServerRequest;
+class AsyncEventSourceClient;
+
+typedef std::function<size_t(uint8_t *, size_t, size_t)> AwsResponseFiller;
+typedef std::function<String(const String &)> AwsTemplateProcessor;
+typedef std::function<void(AsyncWebServerRequest *)> ArRequestHandlerFunction;
+typedef std::function<void(AsyncWebServerRequest *, const String &, size_t, uint8_t *, size_t, bool)> ArUploadHandlerFunction;
+typedef std::function<bool(AsyncWebServerRequest *)> ArRequestFilterFunction;
+typedef std::function<void(void)> ArDisconnectHandler;
+typedef std::function<void(AsyncEventSourceClient *)> ArEventHandlerFunction;
+
+class AsyncWebParameter
+{
+public:
+    AsyncWebParameter(const String &name, const String &value, bool form = false) : parameter_name(name), parameter_value(value), form(form) {}
+    const String &name() const { return parameter_name; }
+    const String &value() const { return parameter_value; }
+    bool isPost() const { return form; }
+    bool isFile() const { return false; }
+
+private:
+    String parameter_name;
+    String parameter_value;
+    bool form;
+};
+
+class AsyncWebHeader
+{
+public:
+    AsyncWebHeader(const String &name, const String &value) : header_name(name), header_value(value) {}
+    const String &name() const { return header_name; }
+    const String &value() const { return header_value; }
+
+private:
+    String header_name;
+    String header_value;
+};
+
+class AsyncWebServerResponse
+{
+public:
+    void setCode(int response_code) { code = response_code; }
+    void setContentType(const String &type) { content_type = type; }
+    void setContentLength(size_t) {}
+    void addHeader(const String &name, const String &value) { headers.emplace_back(name, value); }
+
+    /**
+     * @brief Produce the next chunk of a chunked response, as the server would.
+     *
+     * @param buffer    The buffer for the chunk.
+     * @param maxLen    The space available in `buffer`.
+     * @return The size of the chunk; zero at the end of the response.
+     */
+    size_t read_chunk(uint8_t *buffer, size_t maxLen)
+    {
+        size_t size = filler(buffer, maxLen, sent);
+        sent += size;
+        return size;
+    }
+
+    int code = 200;
+    String content_type;
+    String body;                            //!< The body, for responses that are not chunked.
+    std::vector<AsyncWebHeader> headers;
+    AwsResponseFiller filler;               //!< The chunk filler, for chunked responses.
+    size_t sent = 0;                        //!< The size of the chunks produced so far.
+};
+
+class AsyncWebServerRequest
+{
+public:
+    AsyncWebServerRequest(WebRequestMethod method = HTTP_GET, const String &url = "/") : request_method(method), request_url(url) {}
+    AsyncWebServerRequest(const AsyncWebServerRequest &) = delete;
+    ~AsyncWebServerRequest() { disconnect(); }
+
+    WebRequestMethod method() const { return request_method; }
+    const String &url() const { return request_url; }
+
+    // Query and form parameters.
+    void add_param(const String &name, const String &value, bool form = false) { parameters.emplace_back(name, value, form); }
+    size_t params() const { return parameters.size(); }
+    const AsyncWebParameter *getParam(size_t index) const { return index < parameters.size() ? &parameters[index] : nullptr; }
+    const AsyncWebParameter *getParam(const String &name, bool form = false, bool = false) const
+    {
+        for (const auto &parameter: parameters)
+        {
+            if (parameter.name() == name && parameter.isPost() == form)
+            {
+                return &parameter;
+            }
+        }
+        return nullptr;
+    }
+    bool hasParam(const String &name, bool form = false, bool file = false) const { return getParam(name, form, file) != nullptr; }
+    size_t args() const { return parameters.size(); }
+    const String &arg(size_t index) const { return index < parameters.size() ? parameters[index].value() : empty(); }
+    const String &argName(size_t index) const { return index < parameters.size() ? parameters[index].name() : empty(); }
+    const String &arg(const String &name) const
+    {
+        for (const auto &parameter: parameters)
+        {
+            if (parameter.name() == name)
+            {
+                return parameter.value();
+            }
+        }
+        return empty();
+    }
+    bool hasArg(const String &name) const { return &arg(name) != &empty(); }
+
+    // Headers.
+    void add_header(const String &name, const String &value) { request_headers.emplace_back(name, value); }
+    const AsyncWebHeader *getHeader(const String &name) const
+    {
+        for (const auto &header: request_headers)
+        {
+            if (header.name().equalsIgnoreCase(name))
+            {
+                return &header;
+            }
+        }
+        return nullptr;
+    }
+    bool hasHeader(const String &name) const { return getHeader(name) != nullptr; }
+    const String &header(const String &name) const
+    {
+        const AsyncWebHeader *found = getHeader(name);
+        return found != nullptr ? found->value() : empty();
+    }
+
+    // Authentication always succeeds.
+    bool authenticate(const char *) { return true; }
+    void requestAuthentication(const char * = nullptr, bool = true) { send(401); }
+
+    // Responses.
+    AsyncWebServerResponse *beginResponse(int code, const String &content_type = String(), const String &body = String())
+    {
+        AsyncWebServerResponse *response = new AsyncWebServerResponse;
+        response->code = code;
+        response->content_type = content_type;
+        response->body = body;
+        return response;
+    }
+    AsyncWebServerResponse *beginResponse(FS &fs, const String &path, const String &content_type = String(), bool = false)
+    {
+        File file = fs.open(path, "r");
+        if (!file)
+        {
+            return nullptr;
+        }
+        AsyncWebServerResponse *response = beginResponse(200, content_type);
+        std::string body(file.size(), '\0');
+        file.read(reinterpret_cast<uint8_t *>(&body[0]), body.size());
+        response->body = String(body);
+        return response;
+    }
+    AsyncWebServerResponse *beginResponse_P(int code, const String &content_type, const uint8_t *data, size_t length)
+    {
+        return beginResponse(code, content_type, String(std::string(reinterpret_cast<const char *>(data), length)));
+    }
+    AsyncWebServerResponse *beginResponse_P(int code, const String &content_type, PGM_P body)
+    {
+        return beginResponse(code, content_type, String(body));
+    }
+    AsyncWebServerResponse *beginChunkedResponse(const String &content_type, AwsResponseFiller filler, AwsTemplateProcessor = nullptr)
+    {
+        AsyncWebServerResponse *response = beginResponse(200, content_type);
+        response->filler = filler;
+        return response;
+    }
+    void send(AsyncWebServerResponse *sent) { response.reset(sent); }
+    void send(int code, const String &content_type = String(), const String &body = String())
+    {
+        send(beginResponse(code, content_type, body));
+    }
+    void redirect(const String &url)
+    {
+        send(302);
+        response->addHeader("Location", url);
+    }
+
+    // Disconnection; also on destruction, as the server does when the response is complete.
+    void onDisconnect(ArDisconnectHandler handler) { disconnect_handler = handler; }
+    void disconnect()
+    {
+        ArDisconnectHandler handler;
+        std::swap(handler, disconnect_handler);
+        if (handler)
+        {
+            handler();
+        }
+    }
+
+    std::unique_ptr<AsyncWebServerResponse> response;  //!< The response sent, if any.
+    void *_tempObject = nullptr;
+
+private:
+    static const String &empty()
+    {
+        static const String text;
+        return text;
+    }
+
+    WebRequestMethod request_method;
+    String request_url;
+    std::vector<AsyncWebParameter> parameters;
+    std::vector<AsyncWebHeader> request_headers;
+    ArDisconnectHandler disconnect_handler;
+};
+
+class AsyncWebHandler
+{
+public:
+    virtual ~AsyncWebHandler() {}
+    AsyncWebHandler &setFilter(ArRequestFilterFunction function) { filter = function; return *this; }
+    bool filter_request(AsyncWebServerRequest *request) { return !filter || filter(request); }
+
+private:
+    ArRequestFilterFunction filter;
+};
+
+class AsyncCallbackWebHandler: public AsyncWebHandler
+{
+public:
+    String url;
+    WebRequestMethod method = HTTP_ANY;
+    ArRequestHandlerFunction on_request;
+    ArUploadHandlerFunction on_upload;
+};
+
+class AsyncEventSourceClient
+{
+public:
+    void send(const char *message, const char *event = nullptr, uint32_t = 0, uint32_t = 0)
+    {
+        last_event = event != nullptr ? event : "";
+        last_message = message;
+        ++sent;
+    }
+    void close() { open = false; }
+    bool connected() const { return open; }
+    uint32_t lastId() const { return 0; }
+
+    String last_event;
+    String last_message;
+    size_t sent = 0;
+    bool open = true;
+};
+
+class AsyncEventSource: public AsyncWebHandler
+{
+public:
+    AsyncEventSource(const String &url) : url(url) {}
+    void onConnect(ArEventHandlerFunction handler) { connect_handler = handler; }
+    void send(const char *message, const char *event = nullptr, uint32_t id = 0, uint32_t reconnect = 0)
+    {
+        for (auto &client: clients)
+        {
+            if (client->connected())
+            {
+                client->send(message, event, id, reconnect);
+            }
+        }
+    }
+    size_t count() const
+    {
+        return std::count_if(clients.begin(), clients.end(), [] (const std::unique_ptr<AsyncEventSourceClient> &client) { return client->connected(); });
+    }
+    size_t avgPacketsWaiting() const { return 0; }
+
+    /**
+     * @brief Connect a client, as a browser would, if the filter accepts the request.
+     *
+     * @return The client; null if refused.
+     */
+    AsyncEventSourceClient *connect(AsyncWebServerRequest &request)
+    {
+        if (!filter_request(&request))
+        {
+            return nullptr;
+        }
+        clients.emplace_back(new AsyncEventSourceClient);
+        if (connect_handler)
+        {
+            connect_handler(clients.back().get());
+        }
+        return clients.back().get();
+    }
+
+    String url;
+    std::vector<std::unique_ptr<AsyncEventSourceClient>> clients;
+
+private:
+    ArEventHandlerFunction connect_handler;
+};
+
+class AsyncWebServer
+{
+public:
+    AsyncWebServer(uint16_t) {}
+    AsyncCallbackWebHandler &on(const char *url, WebRequestMethod method, ArRequestHandlerFunction on_request,
+        ArUploadHandlerFunction on_upload = nullptr)
+    {
+        handlers.emplace_back(new AsyncCallbackWebHandler);
+        AsyncCallbackWebHandler &handler = *handlers.back();
+        handler.url = url;
+        handler.method = method;
+        handler.on_request = on_request;
+        handler.on_upload = on_upload;
+        return handler;
+    }
+    AsyncWebHandler &addHandler(AsyncWebHandler *handler)
+    {
+        added_handlers.push_back(handler);
+        return *handler;
+    }
+    void onNotFound(ArRequestHandlerFunction handler) { not_found = handler; }
+    void begin() {}
+    void reset()
+    {
+        handlers.clear();
+        added_handlers.clear();
+    }
+
+    /**
+     * @brief Run the handler for a request.
+     *
+     * @param request   The request.
+     * @param file      A file to pass to the upload handler, in one piece.
+     * @param complete  If `false`, the file is the start of a longer upload; the request is not complete.
+     */
+    void handle(AsyncWebServerRequest &request, const std::vector<uint8_t> &file = std::vector<uint8_t>(), bool complete = true)
+    {
+        for (auto &handler: handlers)
+        {
+            if (handler->url == request.url() && (handler->method & request.method()) != 0 && handler->filter_request(&request))
+            {
+                if (handler->on_upload && !file.empty())
+                {
+                    handler->on_upload(&request, "firmware.bin", 0, const_cast<uint8_t *>(file.data()), file.size(), complete);
+                }
+                if (complete)
+                {
+                    handler->on_request(&request);
+                }
+                return;
+            }
+        }
+        if (not_found)
+        {
+            not_found(&request);
+        }
+    }
+
+    /**
+     * @brief Find a handler added with `addHandler`.
+     *
+     * @tparam T    The handler type.
+     * @return The first added handler of the type; null if there is none.
+     */
+    template<typename T>
+    T *find_handler() const
+    {
+        for (auto handler: added_handlers)
+        {
+            if (auto found = dynamic_cast<T *>(handler))
+            {
+                return found;
+            }
+        }
+        return nullptr;
+    }
+
+private:
+    std::vector<std::unique_ptr<AsyncCallbackWebHandler>> handlers;
+    std::vector<AsyncWebHandler *> added_handlers;
+    ArRequestHandlerFunction not_found;
+};
@@ -0,0 +1,124 @@
+#pragma once
+
+// Host stand-in for the Arduino file system: files are held in memory.
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Arduino.h"
+
+namespace fs
+{
+    enum SeekMode
+    {
+        SeekSet = 0,
+        SeekCur = 1,
+        SeekEnd = 2
+    };
+
+    class File: public Stream
+    {
+    public:
+        File() {}
+        File(std::shared_ptr<std::vector<uint8_t>> data, size_t position) : data(data), offset(position) {}
+
+        size_t write(uint8_t ch) override { return write(&ch, 1); }
+        size_t write(const uint8_t *buffer, size_t length) override
+        {
+            if (!data)
+            {
+                return 0;
+            }
+            if (data->size() < offset + length)
+            {
+                data->resize(offset + length);
+            }
+            memcpy(data->data() + offset, buffer, length);
+            offset += length;
+            return length;
+        }
+        size_t read(uint8_t *buffer, size_t length)
+        {
+            size_t count = std::min(length, static_cast<size_t>(available()));
+            memcpy(buffer, data->data() + offset, count);
+            offset += count;
+            return count;
+        }
+        int read() override
+        {
+            uint8_t ch;
+            return read(&ch, 1) == 1 ? ch : -1;
+        }
+        int peek() override { return available() > 0 ? (*data)[offset] : -1; }
+        int available() override { return data && offset < data->size() ? data->size() - offset : 0; }
+        bool seek(uint32_t position, SeekMode mode = SeekSet)
+        {
+            size_t target = mode == SeekSet ? position : mode == SeekCur ? offset + position : size() + position;
+            if (!data || target > data->size())
+            {
+                return false;
+            }
+            offset = target;
+            return true;
+        }
+        size_t position() const { return offset; }
+        size_t size() const { return data ? data->size() : 0; }
+        void flush() {}
+        void close() { data.reset(); }
+        explicit operator bool() const { return data != nullptr; }
+
+    private:
+        std::shared_ptr<std::vector<uint8_t>> data;
+        size_t offset = 0;
+    };
+
+    class FS
+    {
+    public:
+        bool begin() { return true; }
+        bool format() { files.clear(); return true; }
+        File open(const char *path, const char *mode)
+        {
+            auto existing = files.find(path);
+            if (mode[0] == 'r')
+            {
+                return existing != files.end() ? File(existing->second, 0) : File();
+            }
+            auto &data = files[path];
+            if (!data || mode[0] == 'w')
+            {
+                data = std::make_shared<std::vector<uint8_t>>();
+            }
+            return File(data, mode[0] == 'a' ? data->size() : 0);
+        }
+        File open(const String &path, const char *mode) { return open(path.c_str(), mode); }
+        bool exists(const char *path) { return files.count(path) != 0; }
+        bool exists(const String &path) { return exists(path.c_str()); }
+        bool remove(const char *path) { return files.erase(path) != 0; }
+        bool remove(const String &path) { return remove(path.c_str()); }
+        bool rename(const char *from, const char *to)
+        {
+            auto existing = files.find(from);
+            if (existing == files.end())
+            {
+                return false;
+            }
+            files[to] = existing->second;
+            files.erase(from);
+            return true;
+        }
+        bool rename(const String &from, const String &to) { return rename(from.c_str(), to.c_str()); }
+
+    private:
+        std::map<std::string, std::shared_ptr<std::vector<uint8_t>>> files;
+    };
+}
+
+using fs::File;
+using fs::FS;
+using fs::SeekMode;
+using fs::SeekSet;
+using fs::SeekCur;
+using fs::SeekEnd;
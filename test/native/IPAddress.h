@@ -0,0 +1,18 @@
+#pragma once
+
+#include "Arduino.h"
+
+class IPAddress
+{
+public:
+    IPAddress(uint32_t address = 0) : address(address) {}
+    String toString() const
+    {
+        char buffer[16];
+        snprintf(buffer, sizeof(buffer), "%u.%u.%u.%u", address & 0xff, (address >> 8) & 0xff, (address >> 16) & 0xff, address >> 24);
+        return String(buffer);
+    }
+
+private:
+    uint32_t address;
+};
@@ -0,0 +1,118 @@
+#pragma once
+
+// Host stand-in for the Arduino String class, built on std::string. Like the Arduino
+// class, it allocates on the heap for all but short strings.
+
+#include <stdlib.h>
+
+#include <algorithm>
+#include <cctype>
+#include <string>
+
+#include "pgmspace.h"
+
+class __FlashStringHelper;
+#define FPSTR(p) (reinterpret_cast<const __FlashStringHelper *>(p))
+#define F(s) FPSTR(PSTR(s))
+
+class String
+{
+public:
+    String(const char *text = "") : text(text != nullptr ? text : "") {}
+    String(const __FlashStringHelper *text) : String(reinterpret_cast<const char *>(text)) {}
+    String(const std::string &text) : text(text) {}
+    explicit String(char ch) : text(1, ch) {}
+    explicit String(int value, unsigned char base = 10) : text(to_string(value, base)) {}
+    explicit String(unsigned value, unsigned char base = 10) : text(to_string(value, base)) {}
+    explicit String(long value, unsigned char base = 10) : text(to_string(value, base)) {}
+    explicit String(unsigned long value, unsigned char base = 10) : text(to_string(value, base)) {}
+    explicit String(float value, unsigned char decimals = 2) : String(static_cast<double>(value), decimals) {}
+    explicit String(double value, unsigned char decimals = 2)
+    {
+        char buffer[64];
+        snprintf(buffer, sizeof(buffer), "%.*f", decimals, value);
+        text = buffer;
+    }
+
+    const char *c_str() const { return text.c_str(); }
+    unsigned int length() const { return text.size(); }
+    bool isEmpty() const { return text.empty(); }
+    bool reserve(unsigned int size) { text.reserve(size); return true; }
+    explicit operator bool() const { return true; }
+
+    String &operator+=(const String &other) { text += other.text; return *this; }
+    String &operator+=(const char *other) { text += other; return *this; }
+    String &operator+=(const __FlashStringHelper *other) { text += reinterpret_cast<const char *>(other); return *this; }
+    String &operator+=(char ch) { text += ch; return *this; }
+    String &operator+=(int value) { text += std::to_string(value); return *this; }
+    String &operator+=(unsigned int value) { text += std::to_string(value); return *this; }
+    String &operator+=(long value) { text += std::to_string(value); return *this; }
+    String &operator+=(unsigned long value) { text += std::to_string(value); return *this; }
+    String &operator+=(uint8_t value) { text += std::to_string(value); return *this; }
+    String &operator+=(uint16_t value) { text += std::to_string(value); return *this; }
+    bool concat(const char *other, unsigned int length) { text.append(other, length); return true; }
+    bool concat(const String &other) { text += other.text; return true; }
+    bool concat(char ch) { text += ch; return true; }
+    friend String operator+(const String &left, const String &right) { return String(left.text + right.text); }
+    friend String operator+(const String &left, const char *right) { return String(left.text + right); }
+    friend String operator+(const char *left, const String &right) { return String(left + right.text); }
+
+    bool operator==(const String &other) const { return text == other.text; }
+    bool operator==(const char *other) const { return text == other; }
+    bool operator!=(const String &other) const { return text != other.text; }
+    bool operator!=(const char *other) const { return text != other; }
+    bool operator<(const String &other) const { return text < other.text; }
+    bool equals(const String &other) const { return text == other.text; }
+    bool equalsIgnoreCase(const String &other) const
+    {
+        return text.size() == other.text.size() && std::equal(text.begin(), text.end(), other.text.begin(),
+            [] (char a, char b) { return tolower(a) == tolower(b); });
+    }
+    bool startsWith(const String &prefix) const { return text.compare(0, prefix.text.size(), prefix.text) == 0; }
+    bool endsWith(const String &suffix) const
+    {
+        return text.size() >= suffix.text.size() && text.compare(text.size() - suffix.text.size(), suffix.text.size(), suffix.text) == 0;
+    }
+
+    char operator[](unsigned int index) const { return index < text.size() ? text[index] : '\0'; }
+    char &operator[](unsigned int index) { return text[index]; }
+    char charAt(unsigned int index) const { return (*this)[index]; }
+    const char *begin() const { return text.data(); }
+    const char *end() const { return text.data() + text.size(); }
+    int indexOf(char ch, unsigned int from = 0) const { return position(text.find(ch, from)); }
+    int indexOf(const String &other, unsigned int from = 0) const { return position(text.find(other.text, from)); }
+    int lastIndexOf(char ch) const { return position(text.rfind(ch)); }
+    String substring(unsigned int from) const { return from < text.size() ? String(text.substr(from)) : String(); }
+    String substring(unsigned int from, unsigned int to) const
+    {
+        return from < text.size() && from < to ? String(text.substr(from, to - from)) : String();
+    }
+
+    long toInt() const { return atol(text.c_str()); }
+    float toFloat() const { return atof(text.c_str()); }
+    double toDouble() const { return atof(text.c_str()); }
+    void toLowerCase() { std::transform(text.begin(), text.end(), text.begin(), [] (char ch) { return tolower(ch); }); }
+    void toUpperCase() { std::transform(text.begin(), text.end(), text.begin(), [] (char ch) { return toupper(ch); }); }
+    void trim()
+    {
+        size_t first = text.find_first_not_of(" \t\r\n");
+        size_t last = text.find_last_not_of(" \t\r\n");
+        text = first == std::string::npos ? std::string() : text.substr(first, last - first + 1);
+    }
+
+private:
+    static int position(size_t found) { return found == std::string::npos ? -1 : static_cast<int>(found); }
+    template<typename T>
+    static std::string to_string(T value, unsigned char base)
+    {
+        if (base == 10)
+        {
+            return std::to_string(value);
+        }
+        char buffer[40];
+        snprintf(buffer, sizeof(buffer), "%lx", static_cast<unsigned long>(value));
+        return buffer;
+    }
+
+    std::string text;
+};
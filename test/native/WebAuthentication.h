@@ -0,0 +1,8 @@
+#pragma once
+
+#include "WString.h"
+
+inline String generateDigestHash(const char *username, const char *password, const char *realm)
+{
+    return String(username) + ":" + realm + ":" + password;
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+// Host stand-in for the BearSSL SHA-256 functions.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define br_sha256_SIZE 32
+
+typedef struct
+{
+    uint32_t state[8];
+    uint8_t block[64];
+    uint64_t count;
+} br_sha256_context;
+
+inline void br_sha256_round(br_sha256_context *context)
+{
+    static const uint32_t k[64] = {
+        0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+        0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+        0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+        0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+        0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+        0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+        0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+        0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+    };
+    auto rotate = [] (uint32_t x, int n) { return (x >> n) | (x << (32 - n)); };
+    uint32_t w[64];
+    for (int i = 0; i < 16; ++i)
+    {
+        const uint8_t *p = &context->block[i * 4];
+        w[i] = (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | p[3];
+    }
+    for (int i = 16; i < 64; ++i)
+    {
+        uint32_t s0 = rotate(w[i - 15], 7) ^ rotate(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        uint32_t s1 = rotate(w[i - 2], 17) ^ rotate(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+    uint32_t v[8];
+    memcpy(v, context->state, sizeof(v));
+    for (int i = 0; i < 64; ++i)
+    {
+        uint32_t t1 = v[7] + (rotate(v[4], 6) ^ rotate(v[4], 11) ^ rotate(v[4], 25)) + ((v[4] & v[5]) ^ (~v[4] & v[6])) + k[i] + w[i];
+        uint32_t t2 = (rotate(v[0], 2) ^ rotate(v[0], 13) ^ rotate(v[0], 22)) + ((v[0] & v[1]) ^ (v[0] & v[2]) ^ (v[1] & v[2]));
+        memmove(&v[1], &v[0], 7 * sizeof(uint32_t));
+        v[4] += t1;
+        v[0] = t1 + t2;
+    }
+    for (int i = 0; i < 8; ++i)
+    {
+        context->state[i] += v[i];
+    }
+}
+
+inline void br_sha256_init(br_sha256_context *context)
+{
+    static const uint32_t initial[8] = {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+    };
+    memcpy(context->state, initial, sizeof(initial));
+    context->count = 0;
+}
+
+inline void br_sha256_update(br_sha256_context *context, const void *data, size_t length)
+{
+    const uint8_t *bytes = static_cast<const uint8_t *>(data);
+    for (size_t i = 0; i < length; ++i)
+    {
+        context->block[context->count++ % 64] = bytes[i];
+        if (context->count % 64 == 0)
+        {
+            br_sha256_round(context);
+        }
+    }
+}
+
+inline void br_sha256_out(const br_sha256_context *context, void *out)
+{
+    br_sha256_context final = *context;
+    uint64_t bits = final.count * 8;
+    uint8_t padding = 0x80;
+    br_sha256_update(&final, &padding, 1);
+    padding = 0;
+    while (final.count % 64 != 56)
+    {
+        br_sha256_update(&final, &padding, 1);
+    }
+    uint8_t length[8];
+    for (int i = 0; i < 8; ++i)
+    {
+        length[i] = static_cast<uint8_t>(bits >> (56 - 8 * i));
+    }
+    br_sha256_update(&final, length, sizeof(length));
+    uint8_t *digest = static_cast<uint8_t *>(out);
+    for (int i = 0; i < 8; ++i)
+    {
+        digest[i * 4] = static_cast<uint8_t>(final.state[i] >> 24);
+        digest[i * 4 + 1] = static_cast<uint8_t>(final.state[i] >> 16);
+        digest[i * 4 + 2] = static_cast<uint8_t>(final.state[i] >> 8);
+        digest[i * 4 + 3] = static_cast<uint8_t>(final.state[i]);
+    }
+}
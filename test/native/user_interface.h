@@ -0,0 +1,22 @@
+#pragma once
+
+// Host stand-in for the ESP8266 SDK reset information.
+
+#include <stdint.h>
+
+enum rst_reason
+{
+    REASON_DEFAULT_RST = 0,
+    REASON_WDT_RST,
+    REASON_EXCEPTION_RST,
+    REASON_SOFT_WDT_RST,
+    REASON_SOFT_RESTART,
+    REASON_DEEP_SLEEP_AWAKE,
+    REASON_EXT_SYS_RST
+};
+
+struct rst_info
+{
+    uint32_t reason;
+    uint32_t exccause;
+};
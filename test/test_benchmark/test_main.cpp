@@ -0,0 +1,276 @@
+// Host benchmark for the request handlers: run with
+//
+//     pio test -e native -f test_benchmark -v
+//
+// For 10, 100 and 1000 settings (in tabs of 10), this times the main page, the schema and
+// values JSON, and a save POST, each taken through the registered handler with the chunks
+// drawn as the server would, and reports the time and the number of heap allocations per
+// request. Value escaping is timed separately. The framework classes are the stand-ins in
+// test/native, so the figures compare builds and configurations; they are not device timings.
+// Run on the device with examples/Benchmark and tools/benchmark.py.
+
+#include <unity.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "grmcdorman/HtmlWriter.h"
+#include "grmcdorman/WebSettings.h"
+
+namespace
+{
+    std::atomic<size_t> allocations(0);     //!< The number of heap allocations so far.
+
+    constexpr size_t settings_per_tab = 10;
+    constexpr size_t chunk_size = 1436;     //!< A typical TCP segment, as offered by the server for each chunk.
+    constexpr double minimum_time = 0.2;    //!< Each operation is repeated for at least this many seconds.
+
+    //!< A synthetic configuration: text, number and checkbox settings in turn, in tabs.
+    struct Configuration
+    {
+        explicit Configuration(size_t setting_count);
+
+        //!< Keep a generated name; settings hold their names by pointer, as if in PROGMEM.
+        const __FlashStringHelper *name(const std::string &text)
+        {
+            names.push_back(text);
+            return FPSTR(names.back().c_str());
+        }
+
+        std::deque<std::string> names;
+        std::vector<std::unique_ptr<grmcdorman::SettingInterface>> settings;
+        std::deque<grmcdorman::SettingInterface::settings_list_t> tabs;
+        grmcdorman::WebSettings web_settings;
+    };
+
+    Configuration::Configuration(size_t setting_count)
+    {
+        for (size_t i = 0; i < setting_count; ++i)
+        {
+            const __FlashStringHelper *setting_name = name("s" + std::to_string(i));
+            switch (i % 3)
+            {
+                case 0:
+                    settings.emplace_back(new grmcdorman::StringSetting(setting_name, setting_name));
+                    settings.back()->set_from_string("a \"quoted\" <value> & more");
+                    break;
+                case 1:
+                    settings.emplace_back(new grmcdorman::UnsignedIntegerSetting(setting_name, setting_name));
+                    settings.back()->set_from_string(String(static_cast<unsigned>(i)));
+                    break;
+                default:
+                    settings.emplace_back(new grmcdorman::ToggleSetting(setting_name, setting_name));
+                    break;
+            }
+            if (i % settings_per_tab == 0)
+            {
+                tabs.emplace_back();
+            }
+            tabs.back().push_back(settings.back().get());
+        }
+        for (size_t tab = 0; tab < tabs.size(); ++tab)
+        {
+            web_settings.add_setting_set(name("t" + std::to_string(tab)), tabs[tab]);
+        }
+        web_settings.setup(nullptr, nullptr, nullptr);
+    }
+
+    //!< The result of timing an operation.
+    struct Measurement
+    {
+        double ns_per_op;
+        double allocations_per_op;
+        size_t bytes;           //!< The response size.
+        size_t chunks;          //!< The number of chunks, for a chunked response.
+    };
+
+    //!< Send a request, and draw the whole response; returns the response size.
+    size_t send(grmcdorman::WebSettings &web_settings, AsyncWebServerRequest &request, size_t &chunks)
+    {
+        web_settings.get_server().handle(request);
+        TEST_ASSERT_NOT_NULL(request.response.get());
+        TEST_ASSERT_EQUAL(200, request.response->code);
+        chunks = 0;
+        if (!request.response->filler)
+        {
+            return request.response->body.length();
+        }
+        uint8_t buffer[chunk_size];
+        size_t size;
+        while ((size = request.response->read_chunk(buffer, sizeof(buffer))) != 0)
+        {
+            ++chunks;
+        }
+        return request.response->sent;
+    }
+
+    //!< Time an operation, returning the response size and chunks it reports.
+    Measurement measure(const std::function<size_t(size_t &)> &operation)
+    {
+        using clock = std::chrono::steady_clock;
+        Measurement result{};
+        result.bytes = operation(result.chunks);     // Warm up, e.g. the schema cache.
+        size_t count = 0;
+        size_t allocations_before = allocations;
+        auto start = clock::now();
+        std::chrono::duration<double> elapsed;
+        do
+        {
+            operation(result.chunks);
+            ++count;
+            elapsed = clock::now() - start;
+        } while (elapsed.count() < minimum_time);
+        result.ns_per_op = elapsed.count() * 1e9 / count;
+        result.allocations_per_op = static_cast<double>(allocations - allocations_before) / count;
+        return result;
+    }
+
+    void report(const char *name, size_t setting_count, const Measurement &result)
+    {
+        printf("%-10s %6zu %14.0f %12.1f %10zu %8zu\n", name, setting_count, result.ns_per_op, result.allocations_per_op,
+            result.bytes, result.chunks);
+    }
+
+    void benchmark_settings(size_t setting_count)
+    {
+        Configuration configuration(setting_count);
+        grmcdorman::WebSettings &web_settings = configuration.web_settings;
+
+        report("main page", setting_count, measure([&web_settings] (size_t &chunks)
+        {
+            AsyncWebServerRequest request(HTTP_GET, "/");
+            return send(web_settings, request, chunks);
+        }));
+        report("schema", setting_count, measure([&web_settings] (size_t &chunks)
+        {
+            AsyncWebServerRequest request(HTTP_GET, "/settings/schema");
+            return send(web_settings, request, chunks);
+        }));
+        report("values", setting_count, measure([&web_settings] (size_t &chunks)
+        {
+            AsyncWebServerRequest request(HTTP_GET, "/settings/get");
+            request.add_param("tab", "all");
+            return send(web_settings, request, chunks);
+        }));
+
+        // The form from the main page, with every panel opened; the values are unchanged, so that
+        // each save does the same work.
+        std::vector<std::pair<String, String>> form;
+        for (size_t tab = 0; tab < configuration.tabs.size(); ++tab)
+        {
+            String identifier = "t" + String(static_cast<unsigned>(tab));
+            form.emplace_back(identifier + "$", String());
+            for (auto setting: configuration.tabs[tab])
+            {
+                if (setting->send_to_ui())
+                {
+                    form.emplace_back(identifier + "$" + setting->name(), setting->as_string());
+                }
+            }
+        }
+        report("save", setting_count, measure([&web_settings, &form] (size_t &chunks)
+        {
+            AsyncWebServerRequest request(HTTP_POST, "/settings/set");
+            for (const auto &field: form)
+            {
+                request.add_param(field.first, field.second, true);
+            }
+            return send(web_settings, request, chunks);
+        }));
+    }
+
+    void benchmark_10()
+    {
+        benchmark_settings(10);
+    }
+
+    void benchmark_100()
+    {
+        benchmark_settings(100);
+    }
+
+    void benchmark_1000()
+    {
+        benchmark_settings(1000);
+    }
+
+    void benchmark_escaping()
+    {
+        // A 64-character value, with a quarter of the characters to escape.
+        String value;
+        for (int i = 0; i < 16; ++i)
+        {
+            value += "ab<\"";
+        }
+        uint8_t buffer[512];
+        report("json esc", 1, measure([&value, &buffer] (size_t &)
+        {
+            grmcdorman::HtmlWriter writer(buffer, sizeof(buffer));
+            writer.write_json_escaped(value);
+            return writer.size();
+        }));
+        // Names and descriptions are escaped from PROGMEM.
+        auto text = FPSTR(value.c_str());
+        report("json esc P", 1, measure([text, &buffer] (size_t &)
+        {
+            grmcdorman::HtmlWriter writer(buffer, sizeof(buffer));
+            writer.write_json_escaped(text);
+            return writer.size();
+        }));
+    }
+}
+
+// Count heap allocations; the library uses `new`, and String and the containers use the default allocator.
+void *operator new(size_t size)
+{
+    ++allocations;
+    void *memory = malloc(size != 0 ? size : 1);
+    if (memory == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept
+{
+    ++allocations;
+    return malloc(size != 0 ? size : 1);
+}
+
+void operator delete(void *memory) noexcept
+{
+    free(memory);
+}
+
+void operator delete(void *memory, size_t) noexcept
+{
+    free(memory);
+}
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    printf("%-10s %6s %14s %12s %10s %8s\n", "operation", "count", "ns/op", "allocs/op", "bytes", "chunks");
+    RUN_TEST(benchmark_10);
+    RUN_TEST(benchmark_100);
+    RUN_TEST(benchmark_1000);
+    RUN_TEST(benchmark_escaping);
+    return UNITY_END();
+}
@@ -0,0 +1,154 @@
+// Chunked response tests: run with `pio test -e native -f test_chunks`.
+//
+// Each chunked response is drawn with every chunk size from 1 to `max_chunk_size` bytes,
+// as the server offers the space left in its send buffer. Every chunk but the last must
+// be full, and the chunks together must be the response drawn in a single chunk.
+
+#include <unity.h>
+
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "grmcdorman/WebSettings.h"
+
+namespace
+{
+    constexpr size_t max_chunk_size = 1500;     //!< The largest chunk size tried; more than a TCP segment.
+
+    // Settings of every type, in three tabs; with long values, so that pieces span chunks.
+    grmcdorman::NoteSetting note(F("A <b>note</b>, for the first tab."));
+    grmcdorman::StringSetting text(F("Text"), F("text"));
+    grmcdorman::PasswordSetting password(F("Password"), F("password"));
+    grmcdorman::SignedIntegerSetting signed_integer(F("Signed"), F("signed"));
+    grmcdorman::UnsignedIntegerSetting unsigned_integer(F("Unsigned"), F("unsigned"));
+    grmcdorman::FloatSetting floating(F("Float"), F("float"));
+    grmcdorman::ExclusiveOptionSetting::names_list_t option_names{ F("First"), F("Second"), F("Third") };
+    grmcdorman::ExclusiveOptionSetting option(F("Option"), F("option"), option_names);
+    grmcdorman::ToggleSetting toggle(F("Toggle"), F("toggle"));
+    grmcdorman::InfoSettingHtml info(F("Info"), F("info"));
+
+    std::vector<std::unique_ptr<grmcdorman::StringSetting>> long_settings;
+    std::vector<std::string> long_names;
+
+    grmcdorman::SettingInterface::settings_list_t first_tab{ &note, &text, &password, &signed_integer, &unsigned_integer,
+        &floating, &option, &toggle, &info };
+    grmcdorman::SettingInterface::settings_list_t second_tab;
+    grmcdorman::SettingInterface::settings_list_t third_tab;
+
+    std::unique_ptr<grmcdorman::WebSettings> web_settings;
+
+    //!< Request a URL, drawing the response in chunks of `chunk_size`; the chunks are returned in order.
+    std::vector<std::string> draw(const char *url, const char *tab, size_t chunk_size)
+    {
+        AsyncWebServerRequest request(HTTP_GET, url);
+        if (tab != nullptr)
+        {
+            request.add_param("tab", tab);
+        }
+        web_settings->get_server().handle(request);
+        TEST_ASSERT_NOT_NULL(request.response.get());
+        TEST_ASSERT_TRUE_MESSAGE(static_cast<bool>(request.response->filler), url);
+
+        std::vector<std::string> chunks;
+        std::vector<uint8_t> buffer(chunk_size);
+        size_t size;
+        while ((size = request.response->read_chunk(buffer.data(), chunk_size)) != 0)
+        {
+            TEST_ASSERT_LESS_OR_EQUAL(chunk_size, size);
+            chunks.emplace_back(reinterpret_cast<const char *>(buffer.data()), size);
+            // A chunk size that makes no progress would end the response early, or never end it.
+            TEST_ASSERT_LESS_OR_EQUAL(1 << 20, chunks.size());
+        }
+        return chunks;
+    }
+
+    //!< Draw a URL with every chunk size, and compare each with the response drawn in one chunk.
+    void sweep(const char *url, const char *tab = nullptr)
+    {
+        std::vector<std::string> single = draw(url, tab, 1 << 20);
+        TEST_ASSERT_EQUAL(1, single.size());
+        const std::string &expected = single.front();
+
+        for (size_t chunk_size = 1; chunk_size <= max_chunk_size; ++chunk_size)
+        {
+            std::vector<std::string> chunks = draw(url, tab, chunk_size);
+            char message[96];
+            snprintf(message, sizeof(message), "%s, chunk size %zu", url, chunk_size);
+
+            std::string body;
+            for (size_t i = 0; i < chunks.size(); ++i)
+            {
+                TEST_ASSERT_TRUE_MESSAGE(i + 1 == chunks.size() || chunks[i].size() == chunk_size, message);
+                body += chunks[i];
+            }
+            TEST_ASSERT_EQUAL_MESSAGE((expected.size() + chunk_size - 1) / chunk_size, chunks.size(), message);
+            TEST_ASSERT_TRUE_MESSAGE(body == expected, message);
+        }
+        printf("%s: %zu bytes; %zu chunks of 1436 bytes\n", url, expected.size(), (expected.size() + 1435) / 1436);
+    }
+
+    void test_main_page()
+    {
+        sweep("/");
+    }
+
+    void test_schema()
+    {
+        sweep("/settings/schema");
+    }
+
+    void test_values()
+    {
+        sweep("/settings/get", "all");
+    }
+
+    void test_metrics()
+    {
+        // Nothing else is requested during the sweep, so the metrics do not change.
+        sweep("/metrics");
+    }
+}
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+int main()
+{
+    text.set("Text with \"quotes\", <tags> & a\ttab");
+    password.set("secret");
+    signed_integer.set(-42);
+    unsigned_integer.set(42);
+    floating.set(4.25f);
+    info.set("<i>Info</i>");
+    long_names.reserve(20);
+    for (int i = 0; i < 20; ++i)
+    {
+        long_names.push_back("long" + std::to_string(i));
+        const __FlashStringHelper *name = FPSTR(long_names.back().c_str());
+        long_settings.emplace_back(new grmcdorman::StringSetting(name, name));
+        long_settings.back()->set(String(std::string(150 + i * 7, 'a' + i)) + "\"<&>");
+        (i < 10 ? second_tab : third_tab).push_back(long_settings.back().get());
+    }
+
+    web_settings.reset(new grmcdorman::WebSettings);
+    web_settings->add_setting_set(F("First tab"), F("first"), first_tab);
+    web_settings->add_setting_set(F("Second tab"), F("second"), second_tab);
+    web_settings->add_setting_set(F("Third tab"), F("third"), third_tab);
+    web_settings->set_metrics(true);
+    grmcdorman::WebSettings::notify_t ignore = [] (grmcdorman::WebSettings &) {};
+    web_settings->setup(ignore, ignore, ignore);
+
+    UNITY_BEGIN();
+    RUN_TEST(test_main_page);
+    RUN_TEST(test_schema);
+    RUN_TEST(test_values);
+    RUN_TEST(test_metrics);
+    return UNITY_END();
+}
@@ -0,0 +1,242 @@
+// Response admission tests: run with `pio test -e native -f test_responses`.
+
+#include <unity.h>
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "grmcdorman/WebSettings.h"
+
+namespace
+{
+    constexpr size_t heap_reserve = 4096;       //!< The default heap reserve.
+
+    //!< A server with a number of text settings, in one tab.
+    struct Server
+    {
+        explicit Server(size_t setting_count, bool page_cache = false, bool metrics = false)
+        {
+            for (size_t i = 0; i < setting_count; ++i)
+            {
+                names.push_back("s" + std::to_string(i));
+                settings.emplace_back(new grmcdorman::StringSetting(FPSTR(names.back().c_str()), FPSTR(names.back().c_str())));
+                tab.push_back(settings.back().get());
+            }
+            web_settings.add_setting_set(F("Tab"), F("tab"), tab);
+            web_settings.set_page_cache(page_cache);
+            web_settings.set_metrics(metrics);
+            web_settings.setup(nullptr, [] (grmcdorman::WebSettings &) {}, nullptr);
+            // This renders the page cache, if enabled.
+            web_settings.loop();
+        }
+
+        //!< Request a URL, leaving the connection open; returns the response status.
+        int start(AsyncWebServerRequest &request)
+        {
+            request.add_param("tab", "all");
+            web_settings.get_server().handle(request);
+            TEST_ASSERT_NOT_NULL(request.response.get());
+            if (request.response->code == 503)
+            {
+                TEST_ASSERT_TRUE(request.response->headers.size() != 0 && request.response->headers[0].name() == "Retry-After");
+            }
+            return request.response->code;
+        }
+
+        //!< Request a URL; returns the response status.
+        int get(const char *url)
+        {
+            AsyncWebServerRequest request(HTTP_GET, url);
+            return start(request);
+        }
+
+        std::deque<std::string> names;
+        std::vector<std::unique_ptr<grmcdorman::StringSetting>> settings;
+        grmcdorman::SettingInterface::settings_list_t tab;
+        grmcdorman::WebSettings web_settings;
+    };
+
+    void test_admits_with_free_heap()
+    {
+        Server server(200);
+        TEST_ASSERT_EQUAL(200, server.get("/"));
+        TEST_ASSERT_EQUAL(200, server.get("/settings/schema"));
+        TEST_ASSERT_EQUAL(200, server.get("/settings/get"));
+        TEST_ASSERT_EQUAL(200, server.get("/style.css"));
+        TEST_ASSERT_EQUAL(200, server.get("/script.js"));
+    }
+
+    void test_refuses_without_reserve()
+    {
+        Server server(2);
+        ESP.max_free_block = heap_reserve;
+        TEST_ASSERT_EQUAL(503, server.get("/"));
+        TEST_ASSERT_EQUAL(503, server.get("/settings/schema"));
+        TEST_ASSERT_EQUAL(503, server.get("/settings/get"));
+        TEST_ASSERT_EQUAL(503, server.get("/style.css"));
+        TEST_ASSERT_EQUAL(503, server.get("/script.js"));
+    }
+
+    void test_cost_follows_response_size()
+    {
+        // Room for a small response, but not for a full send buffer.
+        ESP.max_free_block = heap_reserve + 1800;
+        Server small(2);
+        TEST_ASSERT_EQUAL(200, small.get("/settings/schema"));
+        TEST_ASSERT_EQUAL(200, small.get("/settings/get"));
+        Server large(200);
+        TEST_ASSERT_EQUAL(503, large.get("/settings/schema"));
+        TEST_ASSERT_EQUAL(503, large.get("/settings/get"));
+
+        // The style sheet is smaller than the script.
+        ESP.max_free_block = heap_reserve + 2000;
+        TEST_ASSERT_EQUAL(200, small.get("/style.css"));
+        TEST_ASSERT_EQUAL(503, small.get("/script.js"));
+    }
+
+    void test_disconnect_frees_slot()
+    {
+        Server server(20);
+        {
+            // Three responses started, and not drawn; the client of the second disconnects.
+            AsyncWebServerRequest first(HTTP_GET, "/"), second(HTTP_GET, "/settings/get"), third(HTTP_GET, "/settings/schema");
+            TEST_ASSERT_EQUAL(200, server.start(first));
+            TEST_ASSERT_EQUAL(200, server.start(second));
+            TEST_ASSERT_EQUAL(200, server.start(third));
+            TEST_ASSERT_EQUAL(503, server.get("/"));
+            TEST_ASSERT_EQUAL(1, server.web_settings.get_response_slots_exhausted());
+            second.disconnect();
+            TEST_ASSERT_EQUAL(200, server.get("/"));
+        }
+        TEST_ASSERT_EQUAL(200, server.get("/"));
+    }
+
+    void test_cached_page_takes_no_slot()
+    {
+        Server server(20, true);
+        AsyncWebServerRequest first(HTTP_GET, "/"), second(HTTP_GET, "/"), third(HTTP_GET, "/"), fourth(HTTP_GET, "/");
+        TEST_ASSERT_EQUAL(200, server.start(first));
+        TEST_ASSERT_FALSE(static_cast<bool>(first.response->filler));
+        TEST_ASSERT_EQUAL(200, server.start(second));
+        TEST_ASSERT_EQUAL(200, server.start(third));
+        TEST_ASSERT_EQUAL(200, server.start(fourth));
+        // The connections are still open, but all the slots are free.
+        TEST_ASSERT_EQUAL(200, server.get("/settings/get"));
+        TEST_ASSERT_EQUAL(0, server.web_settings.get_response_slots_exhausted());
+    }
+
+    void test_disconnect_abandons_upload()
+    {
+        Server server(2);
+        std::vector<uint8_t> firmware(10000, 0xe9);
+        {
+            AsyncWebServerRequest request(HTTP_POST, "/upload");
+            server.web_settings.get_server().handle(request, firmware, false);
+            TEST_ASSERT_NULL(request.response.get());
+
+            // Another upload is refused while the first is in progress.
+            AsyncWebServerRequest other(HTTP_POST, "/upload");
+            server.web_settings.get_server().handle(other, firmware, false);
+            TEST_ASSERT_NOT_NULL(other.response.get());
+            TEST_ASSERT_EQUAL(500, other.response->code);
+        }
+        // The first client has disconnected; a new upload is accepted.
+        AsyncWebServerRequest request(HTTP_POST, "/upload");
+        server.web_settings.get_server().handle(request, firmware);
+        TEST_ASSERT_NOT_NULL(request.response.get());
+        TEST_ASSERT_EQUAL(200, request.response->code);
+        TEST_ASSERT_TRUE(Update.data == firmware);
+    }
+
+    void test_event_clients_limited()
+    {
+        Server server(2);
+        auto events = server.web_settings.get_server().find_handler<AsyncEventSource>();
+        TEST_ASSERT_NOT_NULL(events);
+        AsyncWebServerRequest first(HTTP_GET, "/settings/events"), second(HTTP_GET, "/settings/events"), third(HTTP_GET, "/settings/events");
+        auto first_client = events->connect(first);
+        TEST_ASSERT_NOT_NULL(first_client);
+        TEST_ASSERT_NOT_NULL(events->connect(second));
+        TEST_ASSERT_NULL(events->connect(third));
+        // Event clients take no response slot.
+        TEST_ASSERT_EQUAL(200, server.get("/settings/get"));
+
+        first_client->close();
+        ESP.max_free_block = heap_reserve;
+        TEST_ASSERT_NULL(events->connect(third));
+        ESP.max_free_block = 30000;
+        TEST_ASSERT_NOT_NULL(events->connect(third));
+
+        server.web_settings.set_event_clients(0);
+        TEST_ASSERT_EQUAL(2, events->count());
+        AsyncWebServerRequest fourth(HTTP_GET, "/settings/events");
+        TEST_ASSERT_NULL(events->connect(fourth));
+    }
+
+    void test_metrics_disabled_after_setup()
+    {
+        Server server(2, false, true);
+        TEST_ASSERT_EQUAL(200, server.get("/metrics"));
+        server.web_settings.set_metrics(false);
+        TEST_ASSERT_EQUAL(404, server.get("/metrics"));
+    }
+
+    void test_background_refresh()
+    {
+        Server server(2);
+        int refreshed = 0, other_refreshed = 0;
+        grmcdorman::InfoSettingHtml info(F("Info"), F("info"));
+        info.set_request_callback([&refreshed] (const grmcdorman::InfoSettingHtml &) { ++refreshed; });
+        grmcdorman::InfoSettingHtml other(F("Other"), F("other"));
+        other.set_request_callback([&other_refreshed] (const grmcdorman::InfoSettingHtml &) { ++other_refreshed; });
+
+        // Only settings with background refresh enabled are refreshed by loop.
+        server.web_settings.loop();
+        TEST_ASSERT_EQUAL(0, refreshed);
+        info.set_background_refresh(true);
+        info.set_background_refresh(true);
+        server.web_settings.loop();
+        server.web_settings.loop();
+        TEST_ASSERT_EQUAL(2, refreshed);
+        TEST_ASSERT_EQUAL(0, other_refreshed);
+
+        {
+            grmcdorman::InfoSettingHtml temporary(F("Temporary"), F("temporary"));
+            temporary.set_request_callback([&other_refreshed] (const grmcdorman::InfoSettingHtml &) { ++other_refreshed; });
+            temporary.set_background_refresh(true);
+            server.web_settings.loop();
+            TEST_ASSERT_EQUAL(3, refreshed);
+            TEST_ASSERT_EQUAL(1, other_refreshed);
+        }
+        info.set_background_refresh(false);
+        server.web_settings.loop();
+        TEST_ASSERT_EQUAL(3, refreshed);
+        TEST_ASSERT_EQUAL(1, other_refreshed);
+    }
+}
+
+void setUp()
+{
+    ESP.max_free_block = 30000;
+}
+
+void tearDown()
+{
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_admits_with_free_heap);
+    RUN_TEST(test_refuses_without_reserve);
+    RUN_TEST(test_cost_follows_response_size);
+    RUN_TEST(test_disconnect_frees_slot);
+    RUN_TEST(test_cached_page_takes_no_slot);
+    RUN_TEST(test_disconnect_abandons_upload);
+    RUN_TEST(test_event_clients_limited);
+    RUN_TEST(test_metrics_disabled_after_setup);
+    RUN_TEST(test_background_refresh);
+    return UNITY_END();
+}
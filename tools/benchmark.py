@@ -0,0 +1,172 @@
+"""Measure the settings web server on a device.
+
+Flash examples/Benchmark (or any application that enables `set_metrics` and
+`set_heap_debug`), then run:
+
+    python tools/benchmark.py http://<device address>/ [--requests N]
+        [--save results.json] [--compare baseline.json]
+
+Each endpoint is requested N times in turn. For each, the client time per
+request and the body size are reported, together with the time the device
+spent on the request and the number of chunks in chunked responses (from
+`/metrics`), and the lowest free heap and largest free block seen while the
+response was sent (from `/debug/heap`). With
+`--save`, the results are written as JSON; with `--compare`, the change from
+an earlier saved run is shown.
+
+Only the Python standard library is used.
+"""
+import argparse
+import json
+import re
+import sys
+import time
+import urllib.parse
+import urllib.request
+
+# (name, method, path); the POST body is built from the schema.
+ENDPOINTS = [
+    ("main page", "GET", "/"),
+    ("schema", "GET", "/settings/schema"),
+    ("values", "GET", "/settings/get?tab=all"),
+    ("save", "POST", "/settings/set"),
+]
+
+# The metrics and heap labels for each path.
+METRICS_LABEL = {
+    "/": 'endpoint="/",method="GET"',
+    "/settings/schema": 'endpoint="/settings/schema",method="GET"',
+    "/settings/get?tab=all": 'endpoint="/settings/get",method="GET"',
+    "/settings/set": 'endpoint="/settings/set",method="POST"',
+}
+HEAP_NAME = {
+    "/": "/",
+    "/settings/get?tab=all": "/settings/get",
+    "/settings/set": "/settings/set",
+}
+
+
+def fetch(base, path, data=None):
+    """Request a path; return the body."""
+    request = urllib.request.Request(urllib.parse.urljoin(base, path), data=data)
+    if data is not None:
+        request.add_header("Content-Type", "application/x-www-form-urlencoded")
+    with urllib.request.urlopen(request, timeout=30) as response:
+        return response.read()
+
+
+def post_body(schema):
+    """Build a form that saves every panel, with a value for each setting.
+
+    Checkboxes are checked; select, info and note settings are left out.
+    """
+    fields = []
+    for panel in schema:
+        identifier = panel["i"]
+        fields.append((identifier + "$", ""))
+        for setting in panel["s"]:
+            name = identifier + "$" + setting.get("n", "")
+            kind = setting.get("t")
+            if kind in ("text", "password"):
+                fields.append((name, "value"))
+            elif kind == "number":
+                fields.append((name, "1"))
+            elif kind == "checkbox":
+                fields.append((name, "on"))
+    return urllib.parse.urlencode(fields).encode()
+
+
+def server_metrics(base):
+    """Return {label: (total seconds, count, chunks)} from the request metrics."""
+    text = fetch(base, "/metrics").decode()
+    metrics = {}
+    pattern = r"^web_settings_(request_duration_seconds_sum|request_duration_seconds_count|response_chunks_total)\{(.*)\} (\S+)$"
+    for kind, label, value in re.findall(pattern, text, flags=re.M):
+        total, count, chunks = metrics.get(label, (0.0, 0, 0))
+        if kind.endswith("_sum"):
+            total = float(value)
+        elif kind.endswith("_count"):
+            count = int(value)
+        else:
+            chunks = int(value)
+        metrics[label] = (total, count, chunks)
+    return metrics
+
+
+def run(base, requests):
+    """Time each endpoint; return {name: results}."""
+    schema = json.loads(fetch(base, "/settings/schema"))
+    body = post_body(schema)
+    results = {}
+    for name, method, path in ENDPOINTS:
+        data = body if method == "POST" else None
+        before = server_metrics(base)
+        size = 0
+        start = time.perf_counter()
+        for _ in range(requests):
+            size = len(fetch(base, path, data))
+        elapsed = time.perf_counter() - start
+        after = server_metrics(base)
+
+        label = METRICS_LABEL[path]
+        total_before, count_before, chunks_before = before.get(label, (0.0, 0, 0))
+        total_after, count_after, chunks_after = after.get(label, (0.0, 0, 0))
+        count = count_after - count_before
+        chunks = (chunks_after - chunks_before) / count if count else 0
+        result = {
+            "client_ms": 1000.0 * elapsed / requests,
+            "bytes": size,
+            "server_ms": 1000.0 * (total_after - total_before) / count if count else None,
+            # Chunked responses only; fewer, fuller chunks mean fewer TCP segments.
+            "chunks": chunks if chunks else None,
+            "bytes_per_chunk": size / chunks if chunks else None,
+        }
+        if path in HEAP_NAME:
+            heap = json.loads(fetch(base, "/debug/heap"))["requests"][HEAP_NAME[path]]
+            result["heap_used"] = heap["free_before"] - heap["free_low"]
+            result["block_low"] = heap["block_low"]
+        results[name] = result
+    return results
+
+
+def format_value(value, baseline):
+    if value is None:
+        return "%10s" % "-"
+    if baseline is None:
+        return "%10.1f" % value
+    return "%10.1f (%+.1f%%)" % (value, 100.0 * (value - baseline) / baseline if baseline else 0.0)
+
+
+def report(results, baseline):
+    columns = ["client_ms", "server_ms", "bytes", "chunks", "bytes_per_chunk", "heap_used", "block_low"]
+    print("%-10s" % "" + "".join("%12s" % column for column in columns))
+    for name, _, _ in ENDPOINTS:
+        line = "%-10s" % name
+        for column in columns:
+            base_value = baseline.get(name, {}).get(column) if baseline else None
+            line += "  " + format_value(results[name].get(column), base_value)
+        print(line)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("url", help="the device address, e.g. http://192.168.1.10/")
+    parser.add_argument("--requests", type=int, default=20, help="requests per endpoint (default 20)")
+    parser.add_argument("--save", help="write the results to this JSON file")
+    parser.add_argument("--compare", help="compare with results saved earlier")
+    args = parser.parse_args()
+
+    baseline = None
+    if args.compare:
+        with open(args.compare) as input_file:
+            baseline = json.load(input_file)
+    results = run(args.url, args.requests)
+    report(results, baseline)
+    if args.save:
+        with open(args.save, "w") as output_file:
+            json.dump(results, output_file, indent=2)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
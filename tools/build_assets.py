@@ -0,0 +1,133 @@
+"""Generate src/grmcdorman/WebAssets.h from the files in assets/.
+
+Each asset is minified, gzip-compressed, and emitted as a PROGMEM byte array,
+together with its length and an FNV-1a hash of the compressed data.
+
+This runs as a PlatformIO pre-build script (see platformio.ini); it can also be
+run directly with `python tools/build_assets.py`. The generated header is
+committed, so that builds without PlatformIO (e.g. the Arduino IDE) do not need
+to run it. The header is only rewritten when its content changes.
+"""
+import gzip
+import io
+import os
+import re
+
+# (source file, C identifier prefix, minifier name)
+ASSETS = [
+    ("style.css", "style_css", "css"),
+    ("script.js", "script_js", "js"),
+]
+
+OUTPUT = os.path.join("src", "grmcdorman", "WebAssets.h")
+
+
+def minify_css(text):
+    """Remove comments and redundant whitespace from CSS."""
+    text = re.sub(r"/\*.*?\*/", "", text, flags=re.S)
+    text = re.sub(r"\s+", " ", text)
+    text = re.sub(r"\s*([{}:;,>])\s*", r"\1", text)
+    text = text.replace(";}", "}")
+    return text.strip()
+
+
+def minify_js(text):
+    """Remove comments, indentation and blank lines from JavaScript.
+
+    This is deliberately conservative: line breaks are kept, so that automatic
+    semicolon insertion is not affected. String literals are respected;
+    regular expression literals containing '//' or '/*' are not supported.
+    """
+    out = []
+    i = 0
+    quote = None
+    while i < len(text):
+        ch = text[i]
+        if quote:
+            out.append(ch)
+            if ch == "\\":
+                out.append(text[i + 1])
+                i += 1
+            elif ch == quote:
+                quote = None
+        elif ch in "\"'`":
+            quote = ch
+            out.append(ch)
+        elif text.startswith("//", i):
+            while i < len(text) and text[i] != "\n":
+                i += 1
+            continue
+        elif text.startswith("/*", i):
+            i = text.index("*/", i) + 2
+            continue
+        else:
+            out.append(ch)
+        i += 1
+    lines = (line.strip() for line in "".join(out).split("\n"))
+    return "\n".join(line for line in lines if line)
+
+
+def compress(data):
+    """gzip-compress; the timestamp is fixed so that output is reproducible."""
+    buffer = io.BytesIO()
+    with gzip.GzipFile(fileobj=buffer, mode="wb", compresslevel=9, mtime=0) as output:
+        output.write(data)
+    return buffer.getvalue()
+
+
+def fnv1a(data):
+    """32-bit FNV-1a hash; must match the C++ implementation."""
+    value = 0x811C9DC5
+    for byte in data:
+        value = ((value ^ byte) * 0x01000193) & 0xFFFFFFFF
+    return value
+
+
+def generate(root):
+    minifiers = {"css": minify_css, "js": minify_js}
+    lines = [
+        "// Generated by tools/build_assets.py from the files in assets/. Do not edit.",
+        "#pragma once",
+        "",
+        "#include <stddef.h>",
+        "#include <stdint.h>",
+        "",
+        "#include <pgmspace.h>",
+        "",
+        "namespace grmcdorman",
+        "{",
+        "    namespace assets",
+        "    {",
+    ]
+    for source, name, kind in ASSETS:
+        with open(os.path.join(root, "assets", source), encoding="utf-8") as f:
+            minified = minifiers[kind](f.read()).encode("utf-8")
+        data = compress(minified)
+        lines.append("        //!< assets/%s: %d bytes minified, %d bytes compressed." % (source, len(minified), len(data)))
+        lines.append("        constexpr uint8_t %s_gz[] PROGMEM = {" % name)
+        for offset in range(0, len(data), 16):
+            lines.append("            " + " ".join("0x%02x," % b for b in data[offset:offset + 16]))
+        lines.append("        };")
+        lines.append("        constexpr size_t %s_gz_length = %d;    //!< Length of `%s_gz`." % (name, len(data), name))
+        lines.append("        constexpr uint32_t %s_gz_hash = 0x%08x;    //!< FNV-1a hash of `%s_gz`." % (name, fnv1a(data), name))
+        lines.append("")
+    lines[-1:] = ["    }", "}", ""]
+    content = "\r\n".join(lines)
+
+    path = os.path.join(root, OUTPUT)
+    try:
+        with open(path, "rb") as f:
+            if f.read().decode("utf-8") == content:
+                return
+    except OSError:
+        pass
+    with open(path, "wb") as f:
+        f.write(content.encode("utf-8"))
+    print("Generated " + OUTPUT)
+
+
+try:
+    Import("env")  # noqa: F821 - provided by PlatformIO.
+    generate(env.subst("$PROJECT_DIR"))  # noqa: F821
+except NameError:
+    generate(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))